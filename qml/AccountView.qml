@@ -41,13 +41,29 @@ StackView {
         item.ToolTip.show(qsTrId('id_copied_to_clipboard'), 2000);
     }
 
+    Component {
+        id: transactions_header
+        RowLayout {
+            spacing: 16
+            Label {
+                text: qsTrId('id_transactions')
+                Layout.fillWidth: true
+                font.pixelSize: 18
+                font.styleName: 'Medium'
+            }
+            TextField {
+                placeholderText: qsTrId('id_search')
+                selectByMouse: true
+                text: transaction_list_view.searchText
+                onTextChanged: transaction_list_view.searchText = text
+            }
+        }
+    }
     Component {
         id: bitcoin_header
-        Label {
-            text: qsTrId('id_transactions')
-            Layout.fillWidth: true
-            font.pixelSize: 18
-            font.styleName: 'Medium'
+        Loader {
+            width: transaction_list_view.width-16
+            sourceComponent: transactions_header
         }
     }
     Component {
@@ -72,15 +88,9 @@ StackView {
                     font.styleName: 'Medium'
                 }
                 Repeater {
-                    model: {
-                        const balances = []
-                        for (let i = 0; i < account_view.account.balances.length; ++i) {
-                            if (!showAllAssets && i === 3) break
-                            balances.push(account_view.account.balances[i])
-                        }
-                        return balances
-                    }
+                    model: account_view.account.balanceModel
                     ItemDelegate {
+                        visible: showAllAssets || index < 3
                         topPadding: 8
                         bottomPadding: 8
                         leftPadding: 16
@@ -93,23 +103,23 @@ StackView {
                         contentItem: RowLayout {
                             spacing: 16
                             AssetIcon {
-                                asset: modelData.asset
+                                asset: model.asset
                             }
                             Label {
                                 Layout.fillWidth: true
-                                text: modelData.asset.name
+                                text: model.asset.name
                                 font.pixelSize: 16
                                 elide: Label.ElideRight
                                 font.styleName: 'Regular'
                             }
                             Label {
-                                text: modelData.displayAmount
+                                text: model.displayAmount
                                 font.pixelSize: 14
                                 font.styleName: 'Regular'
                             }
                         }
                         onClicked: {
-                            account_view.push(asset_view_component, { balance: modelData })
+                            account_view.push(asset_view_component, { balance: model.balance })
                         }
                     }
                 }
@@ -125,11 +135,9 @@ StackView {
                     Layout.alignment: Qt.AlignCenter
                     onClicked: showAllAssets = !showAllAssets
                 }
-                Label {
-                    text: qsTrId('id_transactions')
+                Loader {
+                    sourceComponent: transactions_header
                     Layout.fillWidth: true
-                    font.pixelSize: 18
-                    font.styleName: 'Medium'
                 }
             }
         }
@@ -5,7 +5,7 @@ import QtQuick.Layouts 1.12
 Image {
     property Asset asset
     property real size: 32
-    source: asset.icon || 'qrc:/svg/generic_icon_30p.svg'
+    source: asset && asset.icon || 'qrc:/svg/generic_icon_30p.svg'
     Layout.preferredHeight: size
     Layout.preferredWidth: size
     height: size
@@ -11,11 +11,11 @@ ListView {
     signal clicked(Balance balance)
 
     clip: true
-    model: account.balances
+    model: account.balanceModel
     spacing: 8
 
     delegate: AssetDelegate {
-        balance: modelData
+        balance: model.balance
         width: parent.width
         onClicked: if (hasDetails) list_view.clicked(balance)
     }
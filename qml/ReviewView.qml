@@ -71,6 +71,7 @@ ScrollView {
     Component {
         id: liquid_address
         ColumnLayout {
+            // Null for malformed asset tags
             property Asset address_asset: wallet.getOrCreateAsset(modelData.asset_tag || 'btc')
             spacing: 8
             SectionLabel { text: qsTrId('id_address') }
@@ -82,12 +83,12 @@ ScrollView {
                     asset: address_asset
                 }
                 Label {
-                    text: address_asset.name
+                    text: address_asset ? address_asset.name : modelData.asset_tag
                     elide: Label.ElideMiddle
                 }
             }
             SectionLabel { text: qsTrId('id_amount') }
-            Label { text: address_asset.formatAmount(modelData.satoshi, true, wallet.settings.unit) }
+            Label { text: address_asset ? address_asset.formatAmount(modelData.satoshi, true, wallet.settings.unit) : modelData.satoshi }
         }
     }
 }
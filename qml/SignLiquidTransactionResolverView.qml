@@ -64,6 +64,7 @@ Column {
             id: output_view
             property var output
             property int index
+            // Null for malformed asset ids
             readonly property Asset asset: resolver.handler.wallet.getOrCreateAsset(output.asset_id || 'btc')
             spacing: 16
             SectionLabel {
@@ -78,23 +79,23 @@ Column {
                     anchors.verticalCenter: parent.verticalCenter
                     Label {
                         Layout.fillWidth: true
-                        text: output_view.asset.name
+                        text: output_view.asset ? output_view.asset.name : output.asset_id
                         font.pixelSize: 14
                         elide: Label.ElideRight
                     }
 
                     Label {
-                        visible: 'entity' in output_view.asset.data
+                        visible: !!output_view.asset && 'entity' in output_view.asset.data
                         Layout.fillWidth: true
                         opacity: 0.5
-                        text: output_view.asset.data.entity ? output_view.asset.data.entity.domain : ''
+                        text: output_view.asset && output_view.asset.data.entity ? output_view.asset.data.entity.domain : ''
                         elide: Label.ElideRight
                     }
                 }
             }
             SectionLabel { text: qsTrId('id_amount') }
             Label {
-                text: output_view.asset.formatAmount(output.satoshi, true, 'BTC')
+                text: output_view.asset ? output_view.asset.formatAmount(output.satoshi, true, 'BTC') : output.satoshi
             }
             SectionLabel { text: output.is_change ? qsTrId('id_change_address') : qsTrId('id_recipient_address') }
             Label {
@@ -114,7 +115,7 @@ Column {
             }
             SectionLabel { text: qsTrId('id_fee') }
             Label {
-                text: fee_view.asset.formatAmount(output.satoshi, true, 'BTC')
+                text: fee_view.asset ? fee_view.asset.formatAmount(output.satoshi, true, 'BTC') : output.satoshi
             }
         }
     }
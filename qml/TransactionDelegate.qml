@@ -9,9 +9,18 @@ import QtQuick.Layouts 1.12
 ItemDelegate {
     id: self
 
-    required property Transaction transaction
-    property var tx: transaction.data
-    property int confirmations: transactionConfirmations(transaction)
+    required property var model
+    required property string txhash
+    required property string type
+    required property string memo
+    required property date createdAt
+    required property int confirmations
+    required property var formattedAmounts
+    required property bool isRelevant
+    required property bool canRbf
+    property bool liquid: false
+    // Only used by the actions, rows are rendered from the typed roles
+    readonly property Transaction transaction: model.transaction
 
     hoverEnabled: true
     leftPadding: 0
@@ -22,34 +31,29 @@ ItemDelegate {
 
     spacing: 8
 
-    function txType(tx) {
-        const memo = tx.memo.trim().replace(/\n/g, ' ')
+    function txType() {
         const separator = memo === '' ? '' : ' - '
-        if (tx.type === 'incoming') {
-            for (const o of tx.outputs) {
-                if (o.is_relevant) {
-                    return qsTrId('id_received') + separator + memo
-                }
-            }
+        if (type === 'incoming' && isRelevant) {
+            return qsTrId('id_received') + separator + memo
         }
-        if (tx.type === 'outgoing') {
+        if (type === 'outgoing') {
             return qsTrId('id_sent') + separator + memo
         }
-        if (tx.type === 'redeposit') {
+        if (type === 'redeposit') {
             return qsTrId("id_redeposited") + separator + memo
         }
-        return JSON.stringify(tx, null, '\t')
+        return txhash
     }
     Action {
         id: copy_unblinding_data_action
         text: qsTrId('id_copy_unblinding_data')
-        onTriggered: copyUnblindingData(tool_button, tx)
+        onTriggered: copyUnblindingData(tool_button, self.transaction.data)
     }
     contentItem: RowLayout {
         spacing: 16
 
         Label {
-            text: formatDateTime(tx.created_at)
+            text: formatDateTime(createdAt)
             font.pixelSize: 12
             font.capitalization: Font.AllUppercase
             font.styleName: 'Regular'
@@ -59,7 +63,7 @@ ItemDelegate {
             Layout.fillWidth: true
             font.pixelSize: 16
             font.styleName: 'Medium'
-            text: txType(tx)
+            text: txType()
             elide: Label.ElideRight
         }
         Label {
@@ -69,7 +73,7 @@ ItemDelegate {
             font.pixelSize: 12
             font.styleName: 'Medium'
             font.capitalization: Font.AllUppercase
-            visible: confirmations < (transaction.account.wallet.network.liquid ? 1 : 6)
+            visible: confirmations < (liquid ? 1 : 6)
             topPadding: 4
             bottomPadding: 4
             leftPadding: 12
@@ -80,16 +84,11 @@ ItemDelegate {
             }
         }
         Label {
-            color: tx.type === 'incoming' ? '#00b45a' : 'white'
+            color: type === 'incoming' ? '#00b45a' : 'white'
             Layout.alignment: Qt.AlignRight
             font.pixelSize: 16
             font.styleName: 'Medium'
-            text: {
-                if (transaction.amounts.length > 1) return qsTrId('id_multiple_assets')
-                const amount = transaction.amounts[0]
-                if (amount.asset) return amount.formatAmount(true, transaction.account.wallet.settings.unit, amount.asset.data)
-                return amount.formatAmount(true, transaction.account.wallet.settings.unit)
-            }
+            text: formattedAmounts.length > 1 ? qsTrId('id_multiple_assets') : formattedAmounts.length === 1 ? formattedAmounts[0] : ''
         }
         ToolButton {
             id: tool_button
@@ -100,32 +99,32 @@ ItemDelegate {
                 id: menu
                 MenuItem {
                     text: qsTrId('id_view_in_explorer')
-                    onTriggered: transaction.openInExplorer()
+                    onTriggered: self.transaction.openInExplorer()
                 }
                 MenuItem {
-                    enabled: transaction.account.wallet.network.liquid
+                    enabled: liquid
                     text: qsTrId('Copy unblinded link')
                     onTriggered: {
-                        Clipboard.copy(transaction.unblindedLink())
+                        Clipboard.copy(self.transaction.unblindedLink())
                         ToolTip.show(qsTrId('id_copied_to_clipboard'), 1000)
                     }
                 }
                 Repeater {
-                    model: transaction.account.wallet.network.liquid ? [copy_unblinding_data_action] : []
+                    model: liquid ? [copy_unblinding_data_action] : []
                     MenuItem {
                         action: modelData
                     }
                 }
                 MenuItem {
-                    enabled: transaction.data.can_rbf
+                    enabled: canRbf
                     text: qsTrId('id_increase_fee')
-                    onTriggered: bump_fee_dialog.createObject(window, { transaction }).open()
+                    onTriggered: bump_fee_dialog.createObject(window, { transaction: self.transaction }).open()
                 }
                 MenuSeparator {
                 }
                 MenuItem {
                     text: qsTrId('id_copy_transaction_id')
-                    onTriggered: Clipboard.copy(transaction.data.txhash)
+                    onTriggered: Clipboard.copy(txhash)
                 }
             }
         }
@@ -6,18 +6,24 @@ import QtQuick.Layouts 1.3
 ListView {
     id: list_view
     required property Account account
+    property string searchText
     signal clicked(Transaction transaction)
     clip: true
 
     spacing: 8
 
-    model: TransactionListModel {
-        account: list_view.account
+    model: TransactionFilterModel {
+        text: list_view.searchText
+        model: TransactionListModel {
+            id: transaction_list_model
+            account: list_view.account
+        }
     }
 
     delegate: TransactionDelegate {
         hoverEnabled: false
         width: list_view.width
+        liquid: list_view.account.wallet.network.liquid
         onClicked: list_view.clicked(transaction)
     }
 
@@ -26,20 +32,20 @@ ListView {
     Rectangle {
         anchors.fill: parent
         color: constants.c800
-        visible: model.fetching
+        visible: transaction_list_model.fetching
         opacity: visible ? 0.5 : 0
         Behavior on opacity { OpacityAnimator {} }
     }
 
     ColumnLayout {
-        opacity: model.fetching ? 1 : 0
+        opacity: transaction_list_model.fetching ? 1 : 0
         Behavior on opacity { OpacityAnimator {} }
         anchors.centerIn: parent
         spacing: 16
         BusyIndicator {
             width: 32
             height: 32
-            running: model.fetching
+            running: transaction_list_model.fetching
             anchors.margins: 8
             Layout.alignment: Qt.AlignHCenter
         }
@@ -157,6 +157,23 @@ ApplicationWindow {
                         }
                     }
                 }
+                Menu {
+                    title: qsTrId('Export all transactions')
+                    Repeater {
+                        model: [
+                            { text: 'CSV, one file per account', format: 'csv', merge: false },
+                            { text: 'CSV, single file', format: 'csv', merge: true },
+                            { text: 'JSON Lines, one file per account', format: 'jsonl', merge: false },
+                            { text: 'JSON Lines, single file', format: 'jsonl', merge: true },
+                            { text: 'Binary, one file per account', format: 'bin', merge: false },
+                            { text: 'Binary, single file', format: 'bin', merge: true }
+                        ]
+                        MenuItem {
+                            text: qsTrId(modelData.text)
+                            onTriggered: batch_export_popup.createObject(window, { format: modelData.format, merge: modelData.merge }).open()
+                        }
+                    }
+                }
                 Action {
                     text: qsTrId('&Exit')
                     onTriggered: window.close()
@@ -478,6 +495,67 @@ ApplicationWindow {
         }
     }
 
+    Component {
+        id: batch_export_popup
+        Popup {
+            required property string format
+            required property bool merge
+            id: dialog
+            anchors.centerIn: Overlay.overlay
+            closePolicy: Popup.NoAutoClose
+            modal: true
+            Overlay.modal: Rectangle {
+                color: "#70000000"
+            }
+            onClosed: destroy()
+            onOpened: controller.start()
+            property string error
+            BatchExportController {
+                id: controller
+                format: dialog.format
+                merge: dialog.merge
+                onFinished: {
+                    if (success || !error) dialog.close()
+                    else dialog.error = error
+                }
+            }
+            ColumnLayout {
+                BusyIndicator {
+                    visible: !dialog.error
+                    Layout.alignment: Qt.AlignHCenter
+                }
+                Repeater {
+                    model: controller.jobs
+                    Label {
+                        text: `${accountName(modelData.account)}: ${modelData.rows} (${Math.round(modelData.rowsPerSecond)}/s)`
+                    }
+                }
+                Label {
+                    visible: controller.rows > 0
+                    text: `${controller.rows} (${Math.round(controller.rowsPerSecond)}/s)`
+                }
+                Label {
+                    visible: !!dialog.error
+                    text: dialog.error
+                }
+                Button {
+                    visible: controller.running
+                    flat: true
+                    text: qsTrId('id_cancel')
+                    Layout.alignment: Qt.AlignRight
+                    onClicked: controller.cancel()
+                }
+                Button {
+                    visible: !!dialog.error
+                    flat: true
+                    text: qsTrId('id_ok')
+                    Layout.alignment: Qt.AlignRight
+                    onClicked: dialog.close()
+                }
+            }
+        }
+    }
+
     Component {
         id: export_transactions_popup
         Popup {
@@ -490,13 +568,66 @@ ApplicationWindow {
                 color: "#70000000"
             }
             onClosed: destroy()
-            onOpened: controller.save()
+            property bool started: false
+            property string error
             ExportTransactionsController {
                 id: controller
                 account: dialog.account
-                onSaved: dialog.close()
+                format: format_combo_box.model[format_combo_box.currentIndex].format
+                onSaved: {
+                    if (success || !error) dialog.close()
+                    else dialog.error = error
+                }
+            }
+            ColumnLayout {
+                RowLayout {
+                    visible: !dialog.started
+                    spacing: 16
+                    ComboBox {
+                        id: format_combo_box
+                        flat: true
+                        textRole: 'text'
+                        model: [
+                            { text: 'CSV', format: 'csv' },
+                            { text: 'JSON Lines', format: 'jsonl' },
+                            { text: 'Binary', format: 'bin' }
+                        ]
+                        Layout.minimumWidth: 160
+                    }
+                    Button {
+                        flat: true
+                        text: qsTrId('id_cancel')
+                        onClicked: dialog.close()
+                    }
+                    Button {
+                        flat: true
+                        text: qsTrId('id_continue')
+                        onClicked: {
+                            dialog.started = true
+                            controller.save()
+                        }
+                    }
+                }
+                BusyIndicator {
+                    visible: dialog.started && !dialog.error
+                    Layout.alignment: Qt.AlignHCenter
+                }
+                Label {
+                    visible: dialog.started && !dialog.error && controller.rows > 0
+                    text: `${controller.rows} (${Math.round(controller.rowsPerSecond)}/s)`
+                }
+                Label {
+                    visible: !!dialog.error
+                    text: dialog.error
+                }
+                Button {
+                    visible: !!dialog.error
+                    flat: true
+                    text: qsTrId('id_ok')
+                    Layout.alignment: Qt.AlignRight
+                    onClicked: dialog.close()
+                }
             }
-            BusyIndicator {}
         }
 
     }
@@ -1,6 +1,7 @@
 #include "account.h"
 #include "asset.h"
 #include "balance.h"
+#include "balancelistmodel.h"
 #include "ga.h"
 #include "handlers/getbalancehandler.h"
 #include "json.h"
@@ -14,7 +15,21 @@
 Account::Account(Wallet* wallet)
     : QObject(wallet)
     , m_wallet(wallet)
+    , m_notification_timer(new QTimer(this))
+    , m_balance_model(new BalanceListModel(this))
 {
+    // Rows only move when asset metadata changes
+    connect(m_balance_model, &BalanceListModel::rowsMoved, this, &Account::balancesChanged);
+    m_notification_timer->setSingleShot(true);
+    m_notification_timer->setInterval(300);
+    connect(m_notification_timer, &QTimer::timeout, this, &Account::flushNotifications);
+}
+
+Account::~Account()
+{
+    const auto transactions = m_transactions;
+    m_transactions.clear();
+    qDeleteAll(transactions);
 }
 
 QString Account::name() const
@@ -39,37 +54,33 @@ void Account::update(const QJsonObject& json)
 void Account::updateBalance()
 {
     if (wallet()->network()->isLiquid()) {
+        // Existing balances are updated in place, only added and removed
+        // assets change the rows of the balance model
         auto satoshi = m_json.value("satoshi").toObject();
-        auto balance_by_id = m_balance_by_id;
-        m_balance_by_id.clear();
-        m_balances.clear();
+        auto removed = m_balance_by_id;
+        bool changed = false;
         for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
-            Balance* balance = balance_by_id.take(i.key());
-            if (!balance) balance = new Balance(this);
-            m_balance_by_id.insert(i.key(), balance);
-            balance->setAsset(wallet()->getOrCreateAsset(i.key()));
-            balance->setAmount(i.value().toDouble());
-            m_balances.append(balance);
+            Balance* balance = removed.take(i.key());
+            if (!balance) {
+                Asset* asset = wallet()->getOrCreateAsset(i.key());
+                if (!asset) continue;
+                balance = new Balance(this);
+                balance->setAsset(asset);
+                balance->setAmount(i.value().toDouble());
+                m_balance_by_id.insert(i.key(), balance);
+                m_balance_model->insert(balance);
+                changed = true;
+            } else {
+                balance->setAmount(i.value().toDouble());
+            }
         }
-        std::sort(m_balances.begin(), m_balances.end(), [](const Balance* b1, const Balance* b2) {
-            Asset* a1 = b1->asset();
-            Asset* a2 = b2->asset();
-
-            if (a1->isLBTC()) return true;
-            if (a2->isLBTC()) return false;
-
-            if (a1->hasIcon() && !a2->hasIcon()) return true;
-            if (a2->hasIcon() && !a1->hasIcon()) return false;
-            if (a1->hasIcon() && a2->hasIcon()) return a1->name() < a2->name();
-
-            if (a1->hasData() && !a2->hasData()) return true;
-            if (a2->hasData() && !a1->hasData()) return false;
-            if (a1->hasData() && a2->hasData()) return a1->name() < a2->name();
-
-            return a1->name() < a2->name();
-        });
-        emit balancesChanged();
-        qDeleteAll(balance_by_id.values());
+        for (auto i = removed.constBegin(); i != removed.constEnd(); ++i) {
+            m_balance_by_id.remove(i.key());
+            m_balance_model->remove(i.value());
+            delete i.value();
+            changed = true;
+        }
+        if (changed) emit balancesChanged();
     }
 
     emit balanceChanged();
@@ -79,18 +90,42 @@ void Account::handleNotification(const QJsonObject& notification)
 {
     const auto event = notification.value("event").toString();
     if (event == "transaction") {
-        reload();
-        emit notificationHandled(notification);
+        m_pending_reload = true;
+        // A transaction event supersedes any pending block event
+        m_pending_notification = notification;
     } else if (event == "block") {
         // FIXME: Until gdk notifies of chain reorgs, resync balance every
         // 10 blocks in case a reorged tx is somehow evicted from the mempool
         const auto block = notification.value("block").toObject();
         uint32_t block_height = block.value("block_height").toDouble();
         if (!wallet()->network()->isLiquid() || (block_height % 10) == 0) {
-            reload();
+            m_pending_reload = true;
+        }
+        if (m_pending_notification.value("event").toString() != "transaction") {
+            m_pending_notification = notification;
         }
-        emit notificationHandled(notification);
+    } else {
+        return;
+    }
+    ++m_pending_notification_count;
+    // Don't restart an active timer, otherwise a steady stream of events
+    // would postpone the reload indefinitely
+    if (!m_notification_timer->isActive()) m_notification_timer->start();
+}
+
+void Account::flushNotifications()
+{
+    if (m_pending_notification_count > 1) {
+        qDebug() << "account" << m_pointer << "merged" << m_pending_notification_count << "notifications";
     }
+    const auto notification = m_pending_notification;
+    const bool reload_needed = m_pending_reload;
+    m_pending_notification = {};
+    m_pending_notification_count = 0;
+    m_pending_reload = false;
+
+    if (reload_needed) reload();
+    emit notificationHandled(notification);
 }
 
 qint64 Account::balance() const
@@ -100,36 +135,83 @@ qint64 Account::balance() const
 
 QQmlListProperty<Balance> Account::balances()
 {
-    return { this, &m_balances };
+    return { this, m_balance_model->balances() };
 }
 
 void Account::reload()
 {
     auto handler = new GetBalanceHandler(this);
     connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
         auto balance = handler->result().value("result").toObject();
         m_json.insert("satoshi", balance);
         emit jsonChanged();
         updateBalance();
     });
+    connect(handler, &Handler::error, this, [handler] {
+        handler->deleteLater();
+    });
     QObject::connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
         resolver->resolve();
     });
     handler->exec();
 }
 
-Transaction* Account::getOrCreateTransaction(const QJsonObject& data)
+int Account::updateTransaction(const QJsonObject& data)
 {
-    auto hash = data.value("txhash").toString();
-    auto transaction = m_transactions_by_hash.value(hash);
+    bool changed;
+    const int row = m_transaction_store.insert(data, wallet()->network()->isLiquid(), &changed);
+    if (changed) {
+        m_transaction_index.update(row);
+        auto transaction = m_transactions.value(row);
+        if (transaction) transaction->updateFromData(m_transaction_store.data(row));
+        emit transactionUpdated(row);
+    }
+    return row;
+}
+
+void Account::setTransactionMemo(int row, const QString& memo)
+{
+    m_transaction_store.setMemo(row, memo);
+    m_transaction_index.update(row);
+    auto transaction = m_transactions.value(row);
+    if (transaction) transaction->updateFromData(m_transaction_store.data(row));
+    emit transactionUpdated(row);
+}
+
+Transaction* Account::transaction(int row)
+{
+    auto transaction = m_transactions.value(row);
     if (!transaction) {
-        transaction = new Transaction(this);
-        m_transactions_by_hash.insert(hash, transaction);
+        // Owned by QML and released once no view references it, the store
+        // keeps the data so the object is recreated on the next access
+        transaction = new Transaction(this, row);
+        QQmlEngine::setObjectOwnership(transaction, QQmlEngine::JavaScriptOwnership);
+        connect(transaction, &QObject::destroyed, this, [this, row] {
+            m_transactions.remove(row);
+        });
+        m_transactions.insert(row, transaction);
+        transaction->updateFromData(m_transaction_store.data(row));
     }
-    transaction->updateFromData(data);
     return transaction;
 }
 
+Transaction* Account::getOrCreateTransaction(const QJsonObject& data)
+{
+    return transaction(updateTransaction(data));
+}
+
+qint64 Account::memoryUsage() const
+{
+    qint64 usage = m_transaction_store.memoryUsage();
+    // Rough cost of the materialized objects and their cached json
+    for (auto transaction : m_transactions) {
+        usage += sizeof(Transaction) + transaction->m_amounts.size() * sizeof(TransactionAmount);
+        usage += m_transaction_store.details(transaction->row()).size() * 4;
+    }
+    return usage;
+}
+
 bool Account::isMainAccount() const
 {
     return m_json.value("name").toString() == "";
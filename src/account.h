@@ -1,10 +1,14 @@
 #ifndef GREEN_ACCOUNT_H
 #define GREEN_ACCOUNT_H
 
+#include "transactionindex.h"
+#include "transactionstore.h"
+
 #include <QtQml>
 #include <QObject>
 
 QT_FORWARD_DECLARE_CLASS(Balance)
+QT_FORWARD_DECLARE_CLASS(BalanceListModel)
 QT_FORWARD_DECLARE_CLASS(Transaction)
 QT_FORWARD_DECLARE_CLASS(Wallet)
 
@@ -17,9 +21,11 @@ class Account : public QObject
     Q_PROPERTY(QString name READ name NOTIFY jsonChanged)
     Q_PROPERTY(qint64 balance READ balance NOTIFY balanceChanged)
     Q_PROPERTY(QQmlListProperty<Balance> balances READ balances NOTIFY balancesChanged)
+    Q_PROPERTY(BalanceListModel* balanceModel READ balanceModel CONSTANT)
     QML_ELEMENT
 public:
     explicit Account(Wallet* wallet);
+    ~Account();
 
     Wallet* wallet() const { return m_wallet; }
     int pointer() const { Q_ASSERT(m_pointer >= 0); return m_pointer; }
@@ -35,24 +41,48 @@ public:
     qint64 balance() const;
 
     QQmlListProperty<Balance> balances();
+    BalanceListModel* balanceModel() const { return m_balance_model; }
 
     void updateBalance();
+
+    const TransactionStore& transactionStore() const { return m_transaction_store; }
+    const TransactionIndex& transactionIndex() const { return m_transaction_index; }
+    // Adds or updates the transaction in the store, returns its row
+    int updateTransaction(const QJsonObject& data);
+    void setTransactionMemo(int row, const QString& memo);
+    // Returns the object for the given row, created on access and deleted
+    // by the QML garbage collector once unreferenced
+    Transaction* transaction(int row);
     Transaction *getOrCreateTransaction(const QJsonObject &data);
+
+    Q_INVOKABLE qint64 memoryUsage() const;
 signals:
     void walletChanged();
     void jsonChanged();
     void balanceChanged();
     void balancesChanged();
     void notificationHandled(const QJsonObject& notification);
+    void transactionUpdated(int row);
 public slots:
     void reload();
+private:
+    void flushNotifications();
 private:
     Wallet* const m_wallet;
     int m_pointer{-1};
     QJsonObject m_json;
-    QMap<QString, Transaction*> m_transactions_by_hash;
-    QList<Balance*> m_balances;
+    TransactionStore m_transaction_store;
+    TransactionIndex m_transaction_index{&m_transaction_store};
+    // Live transaction objects by store row
+    QHash<int, Transaction*> m_transactions;
     QMap<QString, Balance*> m_balance_by_id;
+    // Notifications received within a short window are merged into a
+    // single balance reload and a single notificationHandled emission
+    QTimer* const m_notification_timer;
+    QJsonObject m_pending_notification;
+    int m_pending_notification_count{0};
+    bool m_pending_reload{false};
+    BalanceListModel* const m_balance_model;
     friend class Wallet;
 };
 
@@ -0,0 +1,214 @@
+#include "amountconverter.h"
+
+#include <QLocale>
+
+#include <cmath>
+#include <limits>
+
+namespace {
+
+const qint64 COIN = 100000000;
+
+int Decimals(const QString& key)
+{
+    if (key == "btc") return 8;
+    if (key == "mbtc") return 5;
+    if (key == "ubtc" || key == "bits") return 2;
+    if (key == "sats") return 0;
+    return -1;
+}
+
+// Computes a * b / d rounded half away from zero
+qint64 MulDiv(qint64 a, qint64 b, qint64 d)
+{
+    Q_ASSERT(d > 0);
+#ifdef __SIZEOF_INT128__
+    const __int128 n = static_cast<__int128>(a) * b;
+    __int128 q = n / d;
+    const __int128 r = n % d;
+    if (2 * (r < 0 ? -r : r) >= d) q += n < 0 ? -1 : 1;
+    return static_cast<qint64>(q);
+#else
+    return std::llround(static_cast<long double>(a) * b / d);
+#endif
+}
+
+// Parses a decimal string into an integer scaled by 10^decimals. Fails on
+// malformed input, overflow or non zero digits beyond the given precision.
+bool ParseDecimal(const QString& value, int decimals, qint64& result)
+{
+    const quint64 max = std::numeric_limits<qint64>::max();
+    const QString s = value.trimmed();
+    int i = 0;
+    bool negative = false;
+    if (i < s.size() && (s.at(i) == '-' || s.at(i) == '+')) {
+        negative = s.at(i) == '-';
+        ++i;
+    }
+    quint64 acc = 0;
+    int fraction_digits = -1;
+    bool has_digits = false;
+    for (; i < s.size(); ++i) {
+        const ushort c = s.at(i).unicode();
+        if (c == '.') {
+            if (fraction_digits >= 0) return false;
+            fraction_digits = 0;
+            continue;
+        }
+        if (c < '0' || c > '9') return false;
+        has_digits = true;
+        if (fraction_digits >= 0) {
+            if (fraction_digits == decimals) {
+                if (c != '0') return false;
+                continue;
+            }
+            ++fraction_digits;
+        }
+        const quint64 digit = c - '0';
+        if (acc > (max - digit) / 10) return false;
+        acc = acc * 10 + digit;
+    }
+    if (!has_digits) return false;
+    for (int scale = decimals - qMax(fraction_digits, 0); scale > 0; --scale) {
+        if (acc > max / 10) return false;
+        acc *= 10;
+    }
+    result = negative ? -static_cast<qint64>(acc) : static_cast<qint64>(acc);
+    return true;
+}
+
+QString FormatDecimal(qint64 value, int decimals)
+{
+    const bool negative = value < 0;
+    const quint64 abs = negative ? 0 - static_cast<quint64>(value) : static_cast<quint64>(value);
+    QString digits = QString::number(abs);
+    if (decimals > 0) {
+        digits = digits.rightJustified(decimals + 1, '0');
+        digits.insert(digits.size() - decimals, '.');
+    }
+    return negative ? "-" + digits : digits;
+}
+
+} // namespace
+
+QString AmountConverter::unitKey(const QString& unit)
+{
+    return unit == "µBTC" ? "ubtc" : unit.toLower();
+}
+
+QString AmountConverter::format(qint64 satoshi, const QString& key)
+{
+    const int decimals = Decimals(key);
+    Q_ASSERT(decimals >= 0);
+    // Satoshi are exact multiples of the smallest unit, shift the point
+    return FormatDecimal(satoshi, decimals);
+}
+
+bool AmountConverter::parse(const QString& value, const QString& key, qint64& satoshi)
+{
+    const int decimals = Decimals(key);
+    if (decimals < 0) return false;
+    return ParseDecimal(value, decimals, satoshi);
+}
+
+QString AmountConverter::toLocaleString(const QString& number)
+{
+    const QLocale locale = QLocale::system();
+    QString integer = number;
+    QString fraction;
+    const int point = number.indexOf('.');
+    if (point >= 0) {
+        integer = number.left(point);
+        fraction = number.mid(point + 1);
+        while (fraction.endsWith('0')) fraction.chop(1);
+    }
+    const bool negative = integer.startsWith('-');
+    if (negative) integer.remove(0, 1);
+    QString result = locale.toString(integer.toULongLong());
+    if (negative) result.prepend(locale.negativeSign());
+    if (!fraction.isEmpty()) result += locale.decimalPoint() + fraction;
+    return result;
+}
+
+void AmountConverter::setUnit(const QString& unit)
+{
+    m_unit = unit;
+    m_unit_key = unitKey(unit);
+}
+
+QString AmountConverter::format(qint64 satoshi) const
+{
+    return format(satoshi, m_unit_key);
+}
+
+bool AmountConverter::parse(const QString& value, qint64& satoshi) const
+{
+    return parse(value, m_unit_key, satoshi);
+}
+
+void AmountConverter::setFiatRate(const QString& currency, const QString& rate)
+{
+    qint64 fiat_rate;
+    if (!ParseDecimal(rate, 8, fiat_rate) || fiat_rate <= 0) fiat_rate = 0;
+    m_fiat_currency = currency;
+    m_fiat_rate_string = rate;
+    m_fiat_rate = fiat_rate;
+}
+
+QString AmountConverter::formatFiat(qint64 satoshi) const
+{
+    Q_ASSERT(hasFiatRate());
+    // cents = satoshi / 10^8 * rate / 10^8 * 100
+    return FormatDecimal(MulDiv(satoshi, m_fiat_rate, COIN * COIN / 100), 2);
+}
+
+bool AmountConverter::parseFiat(const QString& value, qint64& satoshi) const
+{
+    if (!hasFiatRate()) return false;
+    qint64 fiat;
+    if (!ParseDecimal(value, 8, fiat)) return false;
+    satoshi = MulDiv(fiat, COIN, m_fiat_rate);
+    return true;
+}
+
+QJsonObject AmountConverter::convert(const QJsonObject& value) const
+{
+    auto text = [](const QJsonValue& value, int decimals) {
+        return value.isString() ? value.toString() : QString::number(value.toDouble(), 'f', decimals);
+    };
+
+    qint64 satoshi = 0;
+    bool ok = false;
+    if (value.contains("satoshi")) {
+        ok = ParseDecimal(text(value.value("satoshi"), 0), 0, satoshi);
+    } else if (value.contains("sats")) {
+        ok = ParseDecimal(text(value.value("sats"), 0), 0, satoshi);
+    } else if (value.contains("fiat")) {
+        ok = parseFiat(text(value.value("fiat"), 8), satoshi);
+    } else {
+        for (const QString key : { "btc", "mbtc", "ubtc", "bits" }) {
+            if (!value.contains(key)) continue;
+            ok = parse(text(value.value(key), Decimals(key)), key, satoshi);
+            break;
+        }
+    }
+    if (!ok) return {};
+
+    QJsonObject result{
+        { "satoshi", satoshi },
+        { "sats", QString::number(satoshi) },
+        { "btc", format(satoshi, "btc") },
+        { "mbtc", format(satoshi, "mbtc") },
+        { "ubtc", format(satoshi, "ubtc") },
+        { "bits", format(satoshi, "bits") },
+        { "fiat_currency", m_fiat_currency }
+    };
+    if (hasFiatRate()) {
+        result.insert("fiat", formatFiat(satoshi));
+        result.insert("fiat_rate", m_fiat_rate_string);
+    } else {
+        result.insert("fiat", QJsonValue::Null);
+        result.insert("fiat_rate", QJsonValue::Null);
+    }
+    return result;
+}
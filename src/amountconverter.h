@@ -0,0 +1,49 @@
+#ifndef GREEN_AMOUNTCONVERTER_H
+#define GREEN_AMOUNTCONVERTER_H
+
+#include <QJsonObject>
+#include <QString>
+
+// Converts amounts between satoshi, bitcoin units and fiat without going
+// through GA_convert_amount. Bitcoin units are handled with exact fixed
+// point arithmetic on satoshi, fiat uses the cached exchange rate which is
+// refreshed from settings and ticker notifications.
+class AmountConverter
+{
+public:
+    // Maps a settings unit like "mBTC" or "µBTC" to GDK keys like "mbtc" or "ubtc"
+    static QString unitKey(const QString& unit);
+
+    // Fixed point representation of satoshi in the given unit key, e.g. "0.00100000"
+    static QString format(qint64 satoshi, const QString& key);
+    static bool parse(const QString& value, const QString& key, qint64& satoshi);
+
+    // Strips trailing fractional zeros and applies the system locale separators
+    static QString toLocaleString(const QString& number);
+
+    // Settings unit, its key is cached for the unit less overloads below
+    QString unit() const { return m_unit; }
+    void setUnit(const QString& unit);
+    QString format(qint64 satoshi) const;
+    bool parse(const QString& value, qint64& satoshi) const;
+
+    bool hasFiatRate() const { return m_fiat_rate > 0; }
+    QString fiatCurrency() const { return m_fiat_currency; }
+    void setFiatRate(const QString& currency, const QString& rate);
+
+    QString formatFiat(qint64 satoshi) const;
+    bool parseFiat(const QString& value, qint64& satoshi) const;
+
+    // Same input and output format as GA_convert_amount
+    QJsonObject convert(const QJsonObject& value) const;
+
+private:
+    QString m_unit;
+    QString m_unit_key;
+    QString m_fiat_currency;
+    QString m_fiat_rate_string;
+    // Fiat per bitcoin scaled by 10^8
+    qint64 m_fiat_rate{0};
+};
+
+#endif // GREEN_AMOUNTCONVERTER_H
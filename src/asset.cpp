@@ -1,4 +1,5 @@
 #include "asset.h"
+#include "asseticonprovider.h"
 #include "wallet.h"
 
 #include <QDesktopServices>
@@ -10,6 +11,7 @@ Asset::Asset(const QString& id, Wallet* wallet)
     : QObject(wallet)
     , m_wallet(wallet)
     , m_id(id)
+    , m_icon(AssetIconProvider::url(id))
 {
 }
 
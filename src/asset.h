@@ -28,6 +28,7 @@ public:
     bool isLBTC() const { return m_data.value("name").toString() == "btc"; }
 
     bool hasIcon() const { return !m_icon.isEmpty(); }
+    // image://asset URL served by AssetIconProvider
     QString icon() const { return m_icon; }
     void setIcon(const QString& icon);
 
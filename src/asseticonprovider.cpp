@@ -0,0 +1,88 @@
+#include "asseticonprovider.h"
+#include "util.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+namespace {
+
+// Decoded images are accounted in KiB
+const int MAX_CACHE_COST = 16 * 1024;
+
+// Asset ids come from the network and name the icon files, only accept
+// 64 lowercase hex characters
+bool IsAssetId(const QString& id)
+{
+    if (id.size() != 64) return false;
+    for (const QChar c : id) {
+        if (!(c >= '0' && c <= '9') && !(c >= 'a' && c <= 'f')) return false;
+    }
+    return true;
+}
+
+QString IconPath(const QString& id)
+{
+    return GetDataFile("assets" + QDir::separator() + "icons", id + ".png");
+}
+
+} // namespace
+
+AssetIconProvider::AssetIconProvider()
+    : QQuickImageProvider(QQuickImageProvider::Image)
+{
+    m_images.setMaxCost(MAX_CACHE_COST);
+}
+
+bool AssetIconProvider::store(const QString& id, const QByteArray& png)
+{
+    if (!IsAssetId(id) || png.isEmpty()) return false;
+    const QString path = IconPath(id);
+    {
+        QFile file(path);
+        if (file.size() == png.size() && file.open(QFile::ReadOnly) && file.readAll() == png) return false;
+    }
+    QSaveFile file(path);
+    if (!file.open(QFile::WriteOnly)) return false;
+    file.write(png);
+    return file.commit();
+}
+
+QString AssetIconProvider::url(const QString& id)
+{
+    if (!IsAssetId(id)) return {};
+    const QFileInfo info(IconPath(id));
+    if (!info.exists()) return {};
+    return QString("image://asset/%1?v=%2").arg(id).arg(info.lastModified().toMSecsSinceEpoch());
+}
+
+QImage AssetIconProvider::requestImage(const QString& id, QSize* size, const QSize& requested_size)
+{
+    const QString asset_id = id.section('?', 0, 0);
+    if (!IsAssetId(asset_id)) return {};
+    const QString key = requested_size.isValid() ? QString("%1@%2x%3").arg(id).arg(requested_size.width()).arg(requested_size.height()) : id;
+    {
+        QMutexLocker lock(&m_mutex);
+        if (QImage* image = m_images.object(key)) {
+            if (size) *size = image->size();
+            return *image;
+        }
+    }
+
+    QImage image(IconPath(asset_id), "PNG");
+    if (image.isNull()) {
+        qDebug() << "failed to decode asset icon" << id;
+        return image;
+    }
+    if (requested_size.isValid() && requested_size != image.size()) {
+        image = image.scaled(requested_size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    if (size) *size = image.size();
+
+    QMutexLocker lock(&m_mutex);
+    const int cost = qMax<int>(1, image.sizeInBytes() / 1024);
+    m_images.insert(key, new QImage(image), cost);
+    return image;
+}
@@ -0,0 +1,30 @@
+#ifndef GREEN_ASSETICONPROVIDER_H
+#define GREEN_ASSETICONPROVIDER_H
+
+#include <QCache>
+#include <QImage>
+#include <QMutex>
+#include <QQuickImageProvider>
+
+// Serves asset icons as image://asset/<id>. Icons are persisted as raw PNG
+// files under the data directory and decoded at most once, decoded images
+// are kept in a bounded cache shared by every view.
+class AssetIconProvider : public QQuickImageProvider
+{
+public:
+    AssetIconProvider();
+
+    // Writes the PNG for the given asset, returns true if the file changed
+    static bool store(const QString& id, const QByteArray& png);
+    // Image URL for the given asset or an empty string if there is no icon,
+    // includes the file version so that views reload updated icons
+    static QString url(const QString& id);
+
+    QImage requestImage(const QString& id, QSize* size, const QSize& requested_size) override;
+
+private:
+    QMutex m_mutex;
+    QCache<QString, QImage> m_images;
+};
+
+#endif // GREEN_ASSETICONPROVIDER_H
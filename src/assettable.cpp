@@ -0,0 +1,96 @@
+#include "assettable.h"
+
+#include <QtEndian>
+
+namespace {
+
+const int INITIAL_CAPACITY = 64;
+
+bool ParseNibble(ushort c, uchar& nibble)
+{
+    if (c >= '0' && c <= '9') nibble = c - '0';
+    else if (c >= 'a' && c <= 'f') nibble = c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F') nibble = c - 'A' + 10;
+    else return false;
+    return true;
+}
+
+} // namespace
+
+bool AssetTable::parseId(const QString& hex, Id& id)
+{
+    if (hex.size() != 2 * int(id.size())) return false;
+    const QChar* data = hex.constData();
+    for (size_t i = 0; i < id.size(); ++i) {
+        uchar high, low;
+        if (!ParseNibble(data[2 * i].unicode(), high)) return false;
+        if (!ParseNibble(data[2 * i + 1].unicode(), low)) return false;
+        id[i] = high << 4 | low;
+    }
+    return true;
+}
+
+int AssetTable::slot(const Id& id) const
+{
+    Q_ASSERT(!m_entries.isEmpty());
+    // Asset ids are hashes, their leading bytes are uniformly distributed
+    const int mask = m_entries.size() - 1;
+    int index = qFromUnaligned<quint64>(id.data()) & mask;
+    while (m_entries.at(index).used && m_entries.at(index).id != id) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+AssetTable::Entry* AssetTable::find(const Id& id)
+{
+    if (m_size == 0) return nullptr;
+    Entry& entry = m_entries[slot(id)];
+    return entry.used ? &entry : nullptr;
+}
+
+AssetTable::Entry* AssetTable::insert(const Id& id)
+{
+    // Keep the load factor at or below one half
+    if (2 * (m_size + 1) > m_entries.size()) grow();
+    Entry& entry = m_entries[slot(id)];
+    if (!entry.used) {
+        entry.id = id;
+        entry.used = true;
+        ++m_size;
+    }
+    return &entry;
+}
+
+void AssetTable::grow()
+{
+    QVector<Entry> entries(qMax(INITIAL_CAPACITY, 2 * m_entries.size()));
+    entries.swap(m_entries);
+    for (auto& entry : entries) {
+        if (entry.used) m_entries[slot(entry.id)] = std::move(entry);
+    }
+}
+
+void AssetTable::clear()
+{
+    m_entries.clear();
+    m_size = 0;
+}
+
+QList<Asset*> AssetTable::assets() const
+{
+    QList<Asset*> assets;
+    for (const auto& entry : m_entries) {
+        if (entry.asset) assets.append(entry.asset);
+    }
+    return assets;
+}
+
+qint64 AssetTable::memoryUsage() const
+{
+    qint64 usage = m_entries.capacity() * qint64(sizeof(Entry));
+    for (const auto& entry : m_entries) {
+        usage += entry.data.capacity();
+    }
+    return usage;
+}
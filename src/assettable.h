@@ -0,0 +1,57 @@
+#ifndef GREEN_ASSETTABLE_H
+#define GREEN_ASSETTABLE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include <array>
+
+class Asset;
+
+// Open addressing hash table of the assets known to a wallet, keyed by the
+// 32 byte asset id. Registry metadata is kept as compact JSON and only
+// parsed when the Asset object is materialized for a balance or a
+// transaction, registry entries never referenced by the wallet don't get
+// an Asset.
+class AssetTable
+{
+public:
+    using Id = std::array<uchar, 32>;
+
+    struct Entry {
+        Id id;
+        bool used{false};
+        Asset* asset{nullptr};
+        // Registry metadata as compact JSON, empty if unknown
+        QByteArray data;
+    };
+
+    // Parses a 64 character hex asset id
+    static bool parseId(const QString& hex, Id& id);
+
+    int size() const { return m_size; }
+
+    // Returns the entry of the given id or nullptr, entries are moved when
+    // the table grows so pointers are only valid until the next insert
+    Entry* find(const Id& id);
+    // Returns the existing entry or a new one
+    Entry* insert(const Id& id);
+    void clear();
+
+    // Materialized assets
+    QList<Asset*> assets() const;
+
+    // Approximate heap usage in bytes
+    qint64 memoryUsage() const;
+
+private:
+    int slot(const Id& id) const;
+    void grow();
+
+    QVector<Entry> m_entries;
+    int m_size{0};
+};
+
+#endif // GREEN_ASSETTABLE_H
@@ -0,0 +1,119 @@
+#include "asset.h"
+#include "balance.h"
+#include "balancelistmodel.h"
+
+#include <algorithm>
+
+BalanceListModel::BalanceListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+bool BalanceListModel::SortKey::operator<(const SortKey& other) const
+{
+    if (rank != other.rank) return rank < other.rank;
+    if (name != other.name) return name < other.name;
+    return id < other.id;
+}
+
+BalanceListModel::SortKey BalanceListModel::sortKey(const Balance* balance)
+{
+    const Asset* asset = balance->asset();
+    Q_ASSERT(asset);
+    int rank = 3;
+    if (asset->isLBTC()) {
+        rank = 0;
+    } else if (asset->hasIcon()) {
+        rank = 1;
+    } else if (asset->hasData()) {
+        rank = 2;
+    }
+    return { rank, asset->name(), asset->id() };
+}
+
+int BalanceListModel::position(const SortKey& key) const
+{
+    return std::lower_bound(m_keys.begin(), m_keys.end(), key) - m_keys.begin();
+}
+
+void BalanceListModel::insert(Balance* balance)
+{
+    Q_ASSERT(!m_balances.contains(balance));
+    const auto key = sortKey(balance);
+    const int row = position(key);
+    beginInsertRows(QModelIndex(), row, row);
+    m_balances.insert(row, balance);
+    m_keys.insert(row, key);
+    endInsertRows();
+
+    // Connections are dropped with the balance
+    connect(balance, &Balance::changed, this, [this, balance] { updateBalance(balance); });
+    connect(balance->asset(), &Asset::dataChanged, balance, [this, balance] { updateSortKey(balance); });
+    connect(balance->asset(), &Asset::iconChanged, balance, [this, balance] { updateSortKey(balance); });
+}
+
+void BalanceListModel::remove(Balance* balance)
+{
+    const int row = m_balances.indexOf(balance);
+    Q_ASSERT(row >= 0);
+    beginRemoveRows(QModelIndex(), row, row);
+    m_balances.removeAt(row);
+    m_keys.remove(row);
+    endRemoveRows();
+    balance->disconnect(this);
+}
+
+void BalanceListModel::updateBalance(Balance* balance)
+{
+    const int row = m_balances.indexOf(balance);
+    if (row < 0) return;
+    emit dataChanged(index(row), index(row), { AmountRole, DisplayAmountRole });
+}
+
+void BalanceListModel::updateSortKey(Balance* balance)
+{
+    const int row = m_balances.indexOf(balance);
+    if (row < 0) return;
+    const auto key = sortKey(balance);
+    m_keys.remove(row);
+    const int to = position(key);
+    m_keys.insert(row, key);
+    if (to != row) {
+        // Destination is expressed before the row is taken out
+        beginMoveRows(QModelIndex(), row, row, QModelIndex(), to > row ? to + 1 : to);
+        m_balances.move(row, to);
+        m_keys.move(row, to);
+        endMoveRows();
+        emit dataChanged(index(to), index(to));
+    } else {
+        emit dataChanged(index(row), index(row));
+    }
+}
+
+QHash<int, QByteArray> BalanceListModel::roleNames() const
+{
+    return {
+        { BalanceRole, "balance" },
+        { AssetRole, "asset" },
+        { AmountRole, "amount" },
+        { DisplayAmountRole, "displayAmount" }
+    };
+}
+
+int BalanceListModel::rowCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent);
+    return m_balances.size();
+}
+
+QVariant BalanceListModel::data(const QModelIndex &index, int role) const
+{
+    Balance* balance = m_balances.at(index.row());
+    switch (role) {
+    case BalanceRole: return QVariant::fromValue(balance);
+    case AssetRole: return QVariant::fromValue(balance->asset());
+    case AmountRole: return balance->amount();
+    case DisplayAmountRole: return balance->displayAmount();
+    default: return {};
+    }
+}
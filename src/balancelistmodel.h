@@ -0,0 +1,56 @@
+#ifndef GREEN_BALANCELISTMODEL_H
+#define GREEN_BALANCELISTMODEL_H
+
+#include <QtQml>
+#include <QAbstractListModel>
+#include <QList>
+#include <QVector>
+
+QT_FORWARD_DECLARE_CLASS(Balance)
+
+// Balances of an account sorted by asset: L-BTC first, then assets with
+// icon, then assets with registry metadata, each group by name. The sort
+// key of each balance is cached and only recomputed when its asset
+// changes, rows are inserted, removed, moved or updated in place.
+class BalanceListModel : public QAbstractListModel
+{
+    Q_OBJECT
+    QML_ELEMENT
+    QML_UNCREATABLE("BalanceListModel is instanced by Account.")
+public:
+    enum Role {
+        BalanceRole = Qt::UserRole,
+        AssetRole,
+        AmountRole,
+        DisplayAmountRole,
+    };
+    Q_ENUM(Role)
+
+    explicit BalanceListModel(QObject* parent = nullptr);
+
+    QList<Balance*>* balances() { return &m_balances; }
+
+    void insert(Balance* balance);
+    void remove(Balance* balance);
+
+    QHash<int,QByteArray> roleNames() const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+private:
+    struct SortKey {
+        int rank;
+        QString name;
+        QString id;
+        bool operator<(const SortKey& other) const;
+    };
+    static SortKey sortKey(const Balance* balance);
+    int position(const SortKey& key) const;
+    void updateBalance(Balance* balance);
+    void updateSortKey(Balance* balance);
+private:
+    QList<Balance*> m_balances;
+    // Sort key of each row, parallel to m_balances
+    QVector<SortKey> m_keys;
+};
+
+#endif // GREEN_BALANCELISTMODEL_H
@@ -1,6 +1,8 @@
 #ifndef GREEN_COMMAND_H
 #define GREEN_COMMAND_H
 
+#include "hidframing.h"
+
 #include <QObject>
 
 QT_FORWARD_DECLARE_CLASS(Device)
@@ -31,14 +33,18 @@ public:
     virtual QByteArray payload() const = 0;
     virtual bool parse(const QByteArray& data);
     virtual bool parse(QDataStream& stream) { Q_UNUSED(stream); Q_UNIMPLEMENTED(); Q_UNREACHABLE(); };
-    int readHIDReport(Device* device, QDataStream& stream);
+    // Returns 0 once the response is handled, 1 on failure and 2 while
+    // more reports are expected
+    int readHIDReport(Device* device, const char* report, int size);
+    // Handles a response already reassembled by the transport
+    int readHIDReport(Device* device, const QByteArray& response);
     bool readAPDUResponse(Device* device, int length, QDataStream& stream);
 
     Device* const m_device;
-    uint16_t length;
-    uint16_t offset;
-    QByteArray buf;
+    HIDFrameReader m_reader;
     QByteArray m_response;
+    // Set while in the device queue
+    bool m_queued{false};
 };
 
 class CommandBatch : public Command
@@ -49,7 +55,10 @@ public:
     void exec() override {
         if (m_commands.isEmpty()) return emit finished();
         auto next = m_commands.takeFirst();
-        connect(next, &Command::finished, this, &Command::exec, Qt::QueuedConnection);
+        // Dispatch the next command as soon as the previous response is
+        // handled, device commands finish while the device queue still
+        // holds them so the next request is written right after
+        connect(next, &Command::finished, this, &Command::exec);
         connect(next, &Command::error, this, &Command::error);
         next->exec();
     }
@@ -59,12 +68,13 @@ private:
 
 class GenericCommand : public DeviceCommand
 {
-    const QByteArray m_data;
+    QByteArray m_data;
 public:
     GenericCommand(Device* device, const QByteArray& data, CommandBatch* batch = nullptr)
         : DeviceCommand(device, batch)
         , m_data(data) {}
     QByteArray payload() const override { return m_data; }
+    void setPayload(const QByteArray& data) { m_data = data; }
     virtual bool parse(QDataStream& stream) override { return true; };
 };
 
@@ -0,0 +1,294 @@
+#include "account.h"
+#include "controllers/batchexportcontroller.h"
+#include "device.h"
+#include "transactionstore.h"
+#include "wallet.h"
+#include "walletmanager.h"
+
+#include <QDebug>
+#include <QFileDialog>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+static const int PAGE_SIZE = 30;
+
+BatchExportController::BatchExportController(QObject* parent)
+    : QObject(parent)
+{
+}
+
+BatchExportController::~BatchExportController()
+{
+    for (auto& stream : m_streams) {
+        delete stream.writer;
+        if (stream.file) stream.file->cancelWriting();
+    }
+    if (m_file) m_file->cancelWriting();
+}
+
+void BatchExportController::setMerge(bool merge)
+{
+    if (m_merge == merge) return;
+    Q_ASSERT(!m_running);
+    m_merge = merge;
+    emit mergeChanged(m_merge);
+}
+
+void BatchExportController::setFormat(const QString& format)
+{
+    if (m_format == format) return;
+    if (!TransactionWriter::isSupported(format)) {
+        qWarning() << "unsupported export format" << format;
+        return;
+    }
+    Q_ASSERT(!m_running);
+    m_format = format;
+    emit formatChanged(m_format);
+}
+
+QQmlListProperty<TransactionExportJob> BatchExportController::jobs()
+{
+    return { this, &m_jobs };
+}
+
+int BatchExportController::rows() const
+{
+    int rows = 0;
+    for (auto job : m_jobs) rows += job->rows();
+    return rows;
+}
+
+qreal BatchExportController::rowsPerSecond() const
+{
+    const qint64 elapsed = m_running ? m_timer.elapsed() : m_elapsed;
+    return elapsed > 0 ? 1000.0 * rows() / elapsed : 0;
+}
+
+void BatchExportController::start()
+{
+    const auto now = QDateTime::currentDateTime();
+    const auto documents = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation);
+    const auto path = m_merge
+        ? QFileDialog::getSaveFileName(nullptr, "Export transactions", documents + QDir::separator() + "Transactions - " + now.toString("yyyyMMddhhmmss") + "." + m_format, TransactionWriter::fileFilter(m_format))
+        : QFileDialog::getExistingDirectory(nullptr, "Export transactions", documents);
+    if (path.isEmpty()) {
+        emit finished(false, {});
+        return;
+    }
+    exportTo(path);
+}
+
+void BatchExportController::exportTo(const QString& path)
+{
+    Q_ASSERT(!m_running);
+
+    // Reset the state of a previous run, its files were already released
+    m_failed = false;
+    m_canceled = false;
+    m_error.clear();
+    m_elapsed = 0;
+    m_streams.clear();
+    for (auto job : m_jobs) job->deleteLater();
+    m_jobs.clear();
+
+    QSet<QString> file_names;
+    for (auto wallet : WalletManager::instance()->m_wallets) {
+        if (!wallet->isAuthenticated()) continue;
+        for (auto account : wallet->m_accounts) {
+            Stream stream{};
+            stream.job = new TransactionExportJob(account, !m_merge, this);
+            stream.writer = TransactionWriter::create(m_format, account, m_merge);
+            if (!m_merge) {
+                const auto wallet_name = wallet->device() ? wallet->device()->name() : wallet->name();
+                const auto account_name = account->name().isEmpty() ? qtTrId("id_main_account") : account->name();
+                const QString base = QString(wallet_name + " - " + account_name).replace(QRegularExpression("[/\\\\:*?\"<>|]"), "_");
+                QString name = base;
+                for (int i = 2; file_names.contains(name); ++i) {
+                    name = QString("%1 (%2)").arg(base).arg(i);
+                }
+                file_names.insert(name);
+                stream.file = new QSaveFile(path + QDir::separator() + name + "." + m_format, this);
+                if (!stream.file->open(QFile::WriteOnly)) {
+                    qDebug() << "failed to open" << stream.file->fileName() << stream.file->errorString();
+                    m_error = stream.file->errorString();
+                    m_failed = true;
+                } else if (!write(stream.file, stream.writer->header())) {
+                    m_error = stream.file->errorString();
+                    m_failed = true;
+                }
+            }
+            m_streams.append(stream);
+            m_jobs.append(stream.job);
+        }
+    }
+
+    if (m_merge) {
+        m_file = new QSaveFile(path, this);
+        if (!m_file->open(QFile::WriteOnly)) {
+            qDebug() << "failed to open" << path << m_file->errorString();
+            m_error = m_file->errorString();
+            m_failed = true;
+        } else if (!m_streams.isEmpty() && !write(m_file, m_streams.first().writer->header())) {
+            m_error = m_file->errorString();
+            m_failed = true;
+        }
+    }
+
+    emit jobsChanged();
+    m_running = true;
+    emit runningChanged(m_running);
+    m_timer.start();
+
+    if (m_failed || m_streams.isEmpty()) return finish();
+
+    for (int i = 0; i < m_streams.size(); ++i) {
+        auto job = m_streams.at(i).job;
+        connect(job, &TransactionExportJob::pageReady, this, [this, i](const QJsonArray& transactions) {
+            handlePage(i, transactions);
+        });
+        connect(job, &TransactionExportJob::finished, this, [this, i](bool success) {
+            handleFinished(i, success);
+        });
+        connect(job, &TransactionExportJob::progressChanged, this, &BatchExportController::progressChanged);
+        job->start();
+    }
+}
+
+void BatchExportController::handlePage(int index, const QJsonArray& transactions)
+{
+    auto& stream = m_streams[index];
+    if (m_merge) {
+        if (m_failed) return;
+        for (auto value : transactions) {
+            const auto data = value.toObject();
+            stream.queue.append({ TransactionStore::parseCreatedAt(data), data });
+        }
+        drain();
+    } else {
+        QByteArray page;
+        for (auto value : transactions) {
+            page.append(stream.writer->write(value.toObject()));
+        }
+        // The failure of one account file doesn't affect the others
+        if (!write(stream.file, page)) {
+            m_error = stream.file->errorString();
+            stream.job->cancel();
+        }
+    }
+}
+
+void BatchExportController::handleFinished(int index, bool success)
+{
+    auto& stream = m_streams[index];
+    stream.done = true;
+    if (!success) {
+        m_failed = true;
+        if (m_error.isEmpty()) m_error = "Failed to fetch transactions";
+    }
+    if (m_merge) {
+        // A merged file missing an account is useless, stop the others
+        if (m_failed) {
+            abort();
+            return;
+        }
+        drain();
+    } else if (success) {
+        if (!stream.file->commit()) {
+            qDebug() << "failed to commit" << stream.file->fileName() << stream.file->errorString();
+            m_error = stream.file->errorString();
+            m_failed = true;
+        }
+    } else {
+        stream.file->cancelWriting();
+    }
+    for (const auto& other : m_streams) {
+        if (!other.done) return;
+    }
+    finish();
+}
+
+void BatchExportController::drain()
+{
+    // Each history is newest first, write the newest head while every
+    // unfinished account has a pending transaction
+    forever {
+        int next = -1;
+        for (int i = 0; i < m_streams.size(); ++i) {
+            auto& stream = m_streams[i];
+            // Keep up to two pages per account in memory
+            if (stream.queue.size() < PAGE_SIZE) stream.job->fetchMore();
+            if (stream.queue.isEmpty()) {
+                if (stream.done) continue;
+                return;
+            }
+            if (next < 0 || stream.queue.first().first > m_streams.at(next).queue.first().first) next = i;
+        }
+        if (next < 0) return;
+        auto& stream = m_streams[next];
+        if (!write(m_file, stream.writer->write(stream.queue.takeFirst().second))) {
+            m_error = m_file->errorString();
+            m_failed = true;
+            abort();
+            return;
+        }
+    }
+}
+
+void BatchExportController::cancel()
+{
+    if (!m_running) return;
+    m_canceled = true;
+    m_failed = true;
+    abort();
+}
+
+void BatchExportController::abort()
+{
+    Q_ASSERT(m_failed);
+    if (m_aborting) return;
+    m_aborting = true;
+    // Canceled jobs report back through handleFinished
+    for (int i = 0; i < m_streams.size(); ++i) {
+        if (!m_streams.at(i).done) m_streams.at(i).job->cancel();
+    }
+    m_aborting = false;
+    if (m_running) finish();
+}
+
+bool BatchExportController::write(QSaveFile* file, const QByteArray& data)
+{
+    if (file->write(data) == data.size()) return true;
+    qDebug() << "failed to write" << file->fileName() << file->errorString();
+    return false;
+}
+
+void BatchExportController::finish()
+{
+    m_elapsed = m_timer.elapsed();
+    if (m_file) {
+        if (m_failed) {
+            m_file->cancelWriting();
+        } else if (!m_file->commit()) {
+            qDebug() << "failed to commit" << m_file->fileName() << m_file->errorString();
+            m_error = m_file->errorString();
+            m_failed = true;
+        }
+        m_file->deleteLater();
+        m_file = nullptr;
+    }
+    for (auto& stream : m_streams) {
+        delete stream.writer;
+        stream.writer = nullptr;
+        if (stream.file) {
+            if (!stream.done) stream.file->cancelWriting();
+            stream.file->deleteLater();
+            stream.file = nullptr;
+        }
+    }
+    qDebug() << "batch export" << (m_failed ? "failed" : "finished") << "with" << rows() << "rows in" << m_elapsed << "ms," << rowsPerSecond() << "rows/s";
+    m_running = false;
+    emit runningChanged(m_running);
+    emit progressChanged();
+    emit finished(!m_failed, m_failed && !m_canceled ? m_error : QString());
+}
@@ -0,0 +1,85 @@
+#ifndef GREEN_BATCHEXPORTCONTROLLER_H
+#define GREEN_BATCHEXPORTCONTROLLER_H
+
+#include "transactionexport.h"
+
+#include <QtQml>
+#include <QElapsedTimer>
+#include <QObject>
+
+QT_FORWARD_DECLARE_CLASS(QSaveFile)
+
+// Exports every account of every authenticated wallet, either one file per
+// account or a single file merged by creation time, newest first. Accounts
+// are paged concurrently, requests of the same wallet are serialized by its
+// session bulk lane.
+class BatchExportController : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool merge READ merge WRITE setMerge NOTIFY mergeChanged)
+    Q_PROPERTY(QString format READ format WRITE setFormat NOTIFY formatChanged)
+    Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
+    Q_PROPERTY(QQmlListProperty<TransactionExportJob> jobs READ jobs NOTIFY jobsChanged)
+    Q_PROPERTY(int rows READ rows NOTIFY progressChanged)
+    Q_PROPERTY(qreal rowsPerSecond READ rowsPerSecond NOTIFY progressChanged)
+    QML_ELEMENT
+public:
+    explicit BatchExportController(QObject* parent = nullptr);
+    ~BatchExportController();
+
+    bool merge() const { return m_merge; }
+    void setMerge(bool merge);
+    QString format() const { return m_format; }
+    void setFormat(const QString& format);
+    bool isRunning() const { return m_running; }
+    QQmlListProperty<TransactionExportJob> jobs();
+    int rows() const;
+    qreal rowsPerSecond() const;
+
+public slots:
+    void start();
+    // Path is a directory, or the target file when merging
+    void exportTo(const QString& path);
+    void cancel();
+
+signals:
+    void mergeChanged(bool merge);
+    void formatChanged(const QString& format);
+    void runningChanged(bool running);
+    void jobsChanged();
+    void progressChanged();
+    // Emitted once done, error is empty when the export was canceled
+    void finished(bool success, const QString& error);
+
+private:
+    struct Stream {
+        TransactionExportJob* job;
+        TransactionWriter* writer;
+        // Output file when not merging
+        QSaveFile* file;
+        // Pending transactions by creation time when merging
+        QList<QPair<qint64, QJsonObject>> queue;
+        bool done;
+    };
+    void handlePage(int index, const QJsonArray& transactions);
+    void handleFinished(int index, bool success);
+    void drain();
+    void abort();
+    void finish();
+    static bool write(QSaveFile* file, const QByteArray& data);
+
+    bool m_merge{false};
+    QString m_format{"csv"};
+    bool m_running{false};
+    bool m_failed{false};
+    bool m_aborting{false};
+    bool m_canceled{false};
+    QString m_error;
+    QVector<Stream> m_streams;
+    QList<TransactionExportJob*> m_jobs;
+    QSaveFile* m_file{nullptr};
+    QElapsedTimer m_timer;
+    qint64 m_elapsed{0};
+};
+
+#endif // GREEN_BATCHEXPORTCONTROLLER_H
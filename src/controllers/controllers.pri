@@ -1,6 +1,7 @@
 INCLUDEPATH += $$PWD
 
 HEADERS += \
+    $$PWD/batchexportcontroller.h \
     $$PWD/bumpfeecontroller.h \
     $$PWD/exporttransactionscontroller.h \
     $$PWD/ledgerdevicecontroller.h \
@@ -9,6 +10,7 @@ HEADERS += \
     $$PWD/systemmessagecontroller.h
 
 SOURCES += \
+    $$PWD/batchexportcontroller.cpp \
     $$PWD/bumpfeecontroller.cpp \
     $$PWD/exporttransactionscontroller.cpp \
     $$PWD/ledgerdevicecontroller.cpp \
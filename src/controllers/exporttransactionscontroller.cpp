@@ -1,18 +1,13 @@
 #include "account.h"
-#include "asset.h"
 #include "controllers/exporttransactionscontroller.h"
 #include "device.h"
-#include "handlers/gettransactionshandler.h"
-#include "resolver.h"
-#include "network.h"
-#include "transaction.h"
+#include "transactionexport.h"
 #include "wallet.h"
 
+#include <QDebug>
 #include <QFileDialog>
-#include <QFile>
-#include <QTextStream>
+#include <QSaveFile>
 #include <QStandardPaths>
-#include <QTimer>
 
 ExportTransactionsController::ExportTransactionsController(QObject *parent) : QObject(parent)
 {
@@ -26,11 +21,31 @@ void ExportTransactionsController::setAccount(Account *account)
     emit accountChanged(m_account);
 }
 
+void ExportTransactionsController::setFormat(const QString& format)
+{
+    if (m_format == format) return;
+    if (!TransactionWriter::isSupported(format)) {
+        qWarning() << "unsupported export format" << format;
+        return;
+    }
+    m_format = format;
+    emit formatChanged(m_format);
+}
+
+int ExportTransactionsController::rows() const
+{
+    return m_job ? m_job->rows() : 0;
+}
+
+qreal ExportTransactionsController::rowsPerSecond() const
+{
+    return m_job ? m_job->rowsPerSecond() : 0;
+}
+
 void ExportTransactionsController::save()
 {
     Q_ASSERT(m_account);
     auto wallet = m_account->wallet();
-    auto settings = wallet->settings();
 
     const auto now = QDateTime::currentDateTime();
     const auto name = wallet->device() ? wallet->device()->name() : wallet->name();
@@ -38,96 +53,69 @@ void ExportTransactionsController::save()
     const QString suggestion =
             QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + QDir::separator() +
             name  + " - " + account_name + " - " +
-            now.toString("yyyyMMddhhmmss") + ".csv";
-    m_file_name = QFileDialog::getSaveFileName(nullptr, "Export to CSV", suggestion);
-    if (m_file_name.isEmpty()) {
-        emit saved();
+            now.toString("yyyyMMddhhmmss") + "." + m_format;
+    const auto file_name = QFileDialog::getSaveFileName(nullptr, "Export transactions", suggestion, TransactionWriter::fileFilter(m_format));
+    if (file_name.isEmpty()) {
+        emit saved(false, {});
         return;
     }
 
-    const auto pricing = settings.value("pricing").toObject();
-
-    m_fee_field = QString("fee (%1)").arg(wallet->network()->isLiquid() ? "L-" + settings.value("unit").toString() : settings.value("unit").toString());
-    m_fiat_field = QString("fiat (%1 %2 %3)").arg(pricing.value("currency").toString()).arg(pricing.value("exchange").toString(), now.toString(Qt::ISODate));
-    m_fields = QStringList{"time", "description", "amount", "unit", m_fee_field, m_fiat_field, "txhash", "memo"};
-
-    if (m_include_header) {
-        m_lines.append(m_fields.join(m_separator));
+    // Rows are written as pages arrive, the file is only replaced once
+    // the whole history is written
+    Q_ASSERT(!m_file);
+    m_error.clear();
+    m_file = new QSaveFile(file_name, this);
+    if (!m_file->open(QFile::WriteOnly)) {
+        qDebug() << "failed to open" << file_name << m_file->errorString();
+        m_error = m_file->errorString();
+        finish(false);
+        return;
     }
 
-    QTimer::singleShot(1000, [this] { nextPage(); });
-}
+    m_writer.reset(TransactionWriter::create(m_format, m_account));
+    if (!m_writer) {
+        m_error = "Unsupported format " + m_format;
+        finish(false);
+        return;
+    }
+    if (!write(m_writer->header())) {
+        finish(false);
+        return;
+    }
 
-void ExportTransactionsController::nextPage()
-{
-    auto handler = new GetTransactionsHandler(m_account->pointer(), m_offset, m_count, m_account->wallet());
-    QObject::connect(handler, &Handler::done, this, [this, handler] {
-        auto wallet = m_account->wallet();
-        auto settings = wallet->settings();
-        QJsonArray transactions = handler->result().value("result").toObject().value("transactions").toArray();
+    m_job = new TransactionExportJob(m_account, true, this);
+    connect(m_job, &TransactionExportJob::pageReady, this, [this](const QJsonArray& transactions) {
+        QByteArray page;
         for (auto value : transactions) {
-            auto data = value.toObject();
-            auto transaction = m_account->getOrCreateTransaction(data);
-            const auto block_height = data.value("block_height").toInt();
-            if (block_height == 0) continue;
-            for (auto amount : transaction->m_amounts) {
-                const auto asset = amount->asset();
-                QStringList values;
-                for (auto field : m_fields) {
-                    if (field == "time") {
-                        values.append(data.value("created_at").toString());
-                    } else if (field == "description") {
-                        values.append(data.value("type").toString());
-                    } else if (field == "amount") {
-                        values.append(amount->formatAmount(false).replace(",", "."));
-                    } else if (field == "unit") {
-                        if (asset && !asset->isLBTC()) {
-                            values.append(asset->data().value("ticker").toString());
-                        } else if (asset && asset->isLBTC()) {
-                            values.append("L-" + settings.value("unit").toString());
-                        } else {
-                            values.append(settings.value("unit").toString());
-                        }
-                    } else if (field == m_fee_field) {
-                        if (data.value("type").toString() == "outgoing") {
-                            values.append(wallet->formatAmount(data.value("fee").toInt(), false).replace(",", "."));
-                        } else {
-                            values.append("");
-                        }
-                    } else if (field == m_fiat_field) {
-                        if (asset && !asset->isLBTC()) {
-                            values.append("");
-                        } else {
-                            values.append(wallet->convert({{ "satoshi", amount->amount() }}).value("fiat").toString());
-                        }
-                    } else if (field == "txhash") {
-                        values.append(data.value("txhash").toString());
-                    } else if (field == "memo") {
-                        values.append(data.value("memo").toString().replace("\n", " ").replace(",", "-"));
-                    } else {
-                        Q_UNREACHABLE();
-                    }
-                }
-                m_lines.append(values.join(m_separator));
-            }
-        }
-        if (transactions.size() < m_count) {
-            QFile file(m_file_name);
-            bool result = file.open(QFile::WriteOnly);
-            Q_ASSERT(result);
-
-            QTextStream stream(&file);
-            stream << m_lines.join("\n");
-            emit saved();
-        } else {
-            m_offset += m_count;
-            QTimer::singleShot(100, [this] { nextPage(); });
+            page.append(m_writer->write(value.toObject()));
         }
+        if (!write(page)) m_job->cancel();
     });
+    connect(m_job, &TransactionExportJob::progressChanged, this, &ExportTransactionsController::progressChanged);
+    connect(m_job, &TransactionExportJob::finished, this, &ExportTransactionsController::finish);
+    m_job->start();
+}
 
-    connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
-        resolver->resolve();
-    });
+bool ExportTransactionsController::write(const QByteArray& data)
+{
+    if (m_file->write(data) == data.size()) return true;
+    qDebug() << "failed to write" << m_file->fileName() << m_file->errorString();
+    m_error = m_file->errorString();
+    return false;
+}
 
-    handler->exec();
+void ExportTransactionsController::finish(bool success)
+{
+    if (m_file) {
+        if (success && !m_file->commit()) {
+            qDebug() << "failed to commit" << m_file->fileName() << m_file->errorString();
+            m_error = m_file->errorString();
+            success = false;
+        }
+        if (!success) m_file->cancelWriting();
+        m_file->deleteLater();
+        m_file = nullptr;
+    }
+    if (!success && m_error.isEmpty()) m_error = "Failed to fetch transactions";
+    emit saved(success, success ? QString() : m_error);
 }
@@ -1,39 +1,48 @@
 #ifndef GREEN_EXPORTTRANSACTIONSCONTROLLER_H
 #define GREEN_EXPORTTRANSACTIONSCONTROLLER_H
 
+#include "transactionexport.h"
+
 #include <QtQml>
 #include <QObject>
 
 QT_FORWARD_DECLARE_CLASS(Account)
-QT_FORWARD_DECLARE_CLASS(Handler)
+QT_FORWARD_DECLARE_CLASS(QSaveFile)
 
 class ExportTransactionsController : public QObject
 {
     Q_OBJECT
     Q_PROPERTY(Account* account READ account WRITE setAccount NOTIFY accountChanged)
+    Q_PROPERTY(QString format READ format WRITE setFormat NOTIFY formatChanged)
+    Q_PROPERTY(int rows READ rows NOTIFY progressChanged)
+    Q_PROPERTY(qreal rowsPerSecond READ rowsPerSecond NOTIFY progressChanged)
     QML_ELEMENT
 public:
     explicit ExportTransactionsController(QObject* parent = nullptr);
     Account* account() const { return m_account; }
     void setAccount(Account* account);
+    QString format() const { return m_format; }
+    void setFormat(const QString& format);
+    int rows() const;
+    qreal rowsPerSecond() const;
 public slots:
     void save();
 signals:
     void accountChanged(Account* account);
-    void saved();
+    void formatChanged(const QString& format);
+    void progressChanged();
+    // Emitted once done, error is empty when the export was canceled
+    void saved(bool success, const QString& error);
 private:
-    void nextPage();
+    bool write(const QByteArray& data);
+    void finish(bool success);
 private:
     Account* m_account{nullptr};
-    int m_count{5};
-    int m_offset{0};
-    QString m_file_name;
-    QString m_fee_field;
-    QString m_fiat_field;
-    bool m_include_header{true};
-    QString m_separator{","};
-    QStringList m_fields;
-    QStringList m_lines;
+    QString m_format{"csv"};
+    QSaveFile* m_file{nullptr};
+    QScopedPointer<TransactionWriter> m_writer;
+    TransactionExportJob* m_job{nullptr};
+    QString m_error;
 };
 
 #endif // GREEN_EXPORTTRANSACTIONSCONTROLLER_H
@@ -116,6 +116,7 @@ void ReceiveAddressController::generate()
 
     auto handler = new GetReceiveAddressHandler(m_account);
     connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
         const auto result = handler->result().value("result").toObject();
         m_address = result.value("address").toString();
         auto device = qobject_cast<JadeDevice*>(m_account->wallet()->device());
@@ -147,6 +148,10 @@ void ReceiveAddressController::generate()
         setGenerating(false);
         emit changed();
     });
+    connect(handler, &Handler::error, this, [this, handler] {
+        handler->deleteLater();
+        setGenerating(false);
+    });
     connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
         resolver->resolve();
     });
@@ -4,6 +4,7 @@
 #include "ga.h"
 #include "handler.h"
 #include "json.h"
+#include "ledgerdevice.h"
 #include "network.h"
 #include "networkmanager.h"
 #include "util.h"
@@ -15,6 +16,11 @@
 #include <wally_bip32.h>
 #include <wally_elements.h>
 
+#include <QLoggingCategory>
+
+// APDU timing totals, enable with QT_LOGGING_RULES="green.device.timing.debug=true"
+Q_LOGGING_CATEGORY(lcDeviceTiming, "green.device.timing", QtWarningMsg)
+
 QByteArray pathToData(const QVector<uint32_t>& path)
 {
     Q_ASSERT(path.size() <= 10);
@@ -67,6 +73,50 @@ bool DeviceCommand::readAPDUResponse(Device* device, int length, QDataStream &st
     return result;
 }
 
+void DevicePrivate::enqueue(DeviceCommand* command)
+{
+    Q_ASSERT(!command->m_queued);
+    command->m_queued = true;
+    queue.enqueue(command);
+}
+
+DeviceCommand* DevicePrivate::dequeue()
+{
+    auto command = queue.dequeue();
+    command->m_queued = false;
+    return q->commandDequeued(command) ? nullptr : command;
+}
+
+void DevicePrivate::requestSent()
+{
+    if (!m_timer.isValid()) m_timer.start();
+    m_sent_at = m_timer.nsecsElapsed();
+    if (m_received_at >= 0) m_host_time += m_sent_at - m_received_at;
+}
+
+void DevicePrivate::reportReceived()
+{
+    if (m_timer.isValid()) m_report_at = m_timer.nsecsElapsed();
+}
+
+void DevicePrivate::responseReceived()
+{
+    // Parsing the response and queuing the next request is host overhead
+    Q_ASSERT(m_sent_at >= 0 && m_report_at >= m_sent_at);
+    m_received_at = m_report_at;
+    m_device_time += m_received_at - m_sent_at;
+    m_apdu_count++;
+}
+
+void DevicePrivate::queueDrained()
+{
+    if (m_apdu_count == 0) return;
+    qCDebug(lcDeviceTiming) << m_apdu_count << "APDUs, device latency" << m_device_time / 1000000 << "ms, host overhead" << m_host_time / 1000000 << "ms";
+    m_sent_at = m_received_at = -1;
+    m_apdu_count = 0;
+    m_device_time = m_host_time = 0;
+}
+
 Command::Command(CommandBatch* batch)
     : QObject(batch)
 {
@@ -84,37 +134,25 @@ bool DeviceCommand::parse(const QByteArray& data)
     return parse(stream);
 }
 
-int DeviceCommand::readHIDReport(Device* device, QDataStream& stream)
+int DeviceCommand::readHIDReport(Device* device, const char* report, int size)
 {
-    // General transport
-    uint16_t channel_id;
-    uint8_t command_tag;
-    uint16_t index;
-    stream >> channel_id >> command_tag >> index;
-
-#define CHANNEL_DEFAULT_ID 0x0101
-#define TAG_APDU 0x05
-#define TAG_PING 0x02
-
-    Q_ASSERT(channel_id == CHANNEL_DEFAULT_ID);
-    if (command_tag == TAG_PING) Q_UNIMPLEMENTED();
-    Q_ASSERT(command_tag == TAG_APDU);
-
-    if (index == 0) {
-        Q_ASSERT(buf.size() == 0);
-        stream >> length;
-        buf.resize(length);
-        offset = 0;
+    switch (m_reader.read(report, size)) {
+    case HIDFrameReader::Incomplete: return 2;
+    case HIDFrameReader::Invalid:
+        qDebug() << "invalid HID report" << QByteArray(report, size).toHex();
+        m_reader.reset();
+        emit error();
+        return 1;
+    case HIDFrameReader::Complete:
+        break;
     }
+    const int r = readHIDReport(device, m_reader.response());
+    m_reader.reset();
+    return r;
+}
 
-    int read = stream.readRawData(buf.data() + offset, length);
-    length -= read;
-    offset += read;
-
-    if (length > 0) return 2;
-
-    //qDebug() << "READ APDU RESPONSE" << buf.toHex();
-
-    QDataStream s(buf);
-    return readAPDUResponse(device, buf.size(), s) ? 0 : 1;
+int DeviceCommand::readHIDReport(Device* device, const QByteArray& response)
+{
+    QDataStream stream(response);
+    return readAPDUResponse(device, response.size(), stream) ? 0 : 1;
 }
@@ -10,6 +10,7 @@
 #define LEDGER_NANOS_ID 0x0001
 #define LEDGER_NANOX_ID 0x0004
 
+QT_FORWARD_DECLARE_CLASS(DeviceCache);
 QT_FORWARD_DECLARE_CLASS(DeviceCommand);
 QT_FORWARD_DECLARE_CLASS(Network);
 
@@ -101,10 +102,15 @@ public:
     virtual SignLiquidTransactionActivity* signLiquidTransaction(const QJsonObject& transaction, const QJsonArray& signing_inputs, const QJsonArray& outputs) = 0;
 
     static Type typefromVendorAndProduct(uint32_t vendor_id, uint32_t product_id);
+
+    // Persistent cache of the device, available once the master xpub is known
+    DeviceCache* cache() const { return m_cache; }
+    void setCache(DeviceCache* cache) { m_cache = cache; }
 signals:
     void nameChanged();
 private:
     const QString m_uuid;
+    DeviceCache* m_cache{nullptr};
 };
 
 QT_FORWARD_DECLARE_CLASS(LedgerDevice);
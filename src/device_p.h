@@ -2,6 +2,9 @@
 #define GREEN_DEVICE_P_H
 
 #include "device.h"
+#include "hidframing.h"
+
+#include <QElapsedTimer>
 
 class DevicePrivate
 {
@@ -14,6 +17,28 @@ public:
     Device::Type m_type;
     int32_t m_unique_id;
     QQueue<DeviceCommand*> queue;
+    HIDFrameWriter m_writer;
+
+    void enqueue(DeviceCommand* command);
+    // Removes the head of the queue, commands released while queued are
+    // recycled here and nullptr is returned for them
+    DeviceCommand* dequeue();
+
+    // APDU timing, device latency is measured from writing a request to
+    // its complete response and host overhead from a response to writing
+    // the next request, totals are logged to green.device.timing when the
+    // queue drains
+    void requestSent();
+    void reportReceived();
+    void responseReceived();
+    void queueDrained();
+    QElapsedTimer m_timer;
+    qint64 m_sent_at{-1};
+    qint64 m_report_at{-1};
+    qint64 m_received_at{-1};
+    int m_apdu_count{0};
+    qint64 m_device_time{0};
+    qint64 m_host_time{0};
 };
 
 #endif // GREEN_DEVICE_P_H
@@ -0,0 +1,221 @@
+#include "devicecache.h"
+#include "util.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QMessageAuthenticationCode>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <wally_bip32.h>
+
+namespace {
+
+const QByteArray MAGIC = QByteArrayLiteral("GDVC");
+const quint32 FORMAT_VERSION = 2;
+const int MAC_SIZE = 32;
+
+QByteArray Mac(const QString& master_xpub, const QByteArray& data)
+{
+    return QMessageAuthenticationCode::hash(data, master_xpub.toLatin1(), QCryptographicHash::Sha256);
+}
+
+QByteArray Fingerprint(const QString& xpub)
+{
+    ext_key* key;
+    if (bip32_key_from_base58_alloc(xpub.toLatin1().constData(), &key) != WALLY_OK) return {};
+    QByteArray fingerprint(BIP32_KEY_FINGERPRINT_LEN, 0);
+    bip32_key_get_fingerprint(key, (unsigned char*) fingerprint.data(), fingerprint.size());
+    bip32_key_free(key);
+    return fingerprint;
+}
+
+QCborArray PathToCbor(const QVector<uint32_t>& path)
+{
+    QCborArray array;
+    for (auto p : path) array.append(qint64(p));
+    return array;
+}
+
+QVector<uint32_t> PathFromCbor(const QCborArray& array)
+{
+    QVector<uint32_t> path;
+    for (const auto& p : array) path.append(uint32_t(p.toInteger()));
+    return path;
+}
+
+} // namespace
+
+DeviceCache* DeviceCache::get(const QString& network, const QString& master_xpub)
+{
+    // Keyed by the full master xpub, devices sharing a fingerprint get their
+    // own instance and callers can keep the returned pointer
+    static QHash<QString, DeviceCache*> caches;
+
+    const QString key = network + "-" + master_xpub;
+    DeviceCache* cache = caches.value(key);
+    if (cache) return cache;
+
+    const QByteArray fingerprint = Fingerprint(master_xpub);
+    if (fingerprint.isEmpty()) return nullptr;
+    const QString name = network + "-" + QString::fromLatin1(fingerprint.toHex());
+    cache = new DeviceCache(GetDataFile("devices", name), master_xpub);
+    cache->load();
+    caches.insert(key, cache);
+    return cache;
+}
+
+DeviceCache::DeviceCache(const QString& path, const QString& master_xpub)
+    : m_path(path)
+    , m_master_xpub(master_xpub)
+{
+    m_save_timer.setSingleShot(true);
+    m_save_timer.setInterval(1000);
+    QObject::connect(&m_save_timer, &QTimer::timeout, [this] { write(); });
+    // Instances are never destroyed, flush a pending save on exit
+    QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, &m_save_timer, [this] {
+        m_save_timer.stop();
+        write();
+    });
+}
+
+void DeviceCache::clear()
+{
+    m_xpubs.clear();
+    m_nonces.clear();
+    m_nonce_keys.clear();
+    m_blinding_keys.clear();
+    m_dirty = true;
+}
+
+void DeviceCache::setXPub(const QVector<uint32_t>& path, const QString& xpub)
+{
+    if (m_xpubs.value(path) == xpub) return;
+    m_xpubs.insert(path, xpub);
+    m_dirty = true;
+}
+
+QByteArray DeviceCache::nonce(const QByteArray& pubkey, const QByteArray& script) const
+{
+    return m_nonces.value(script + pubkey);
+}
+
+void DeviceCache::setNonce(const QByteArray& pubkey, const QByteArray& script, const QByteArray& nonce)
+{
+    const QByteArray key = script + pubkey;
+    auto it = m_nonces.find(key);
+    if (it != m_nonces.end()) {
+        if (it.value() == nonce) return;
+        it.value() = nonce;
+    } else {
+        m_nonces.insert(key, nonce);
+        m_nonce_keys.enqueue(key);
+        while (m_nonce_keys.size() > MAX_NONCES) m_nonces.remove(m_nonce_keys.dequeue());
+    }
+    m_dirty = true;
+}
+
+void DeviceCache::setBlindingKey(const QString& script, const QByteArray& key)
+{
+    auto& value = m_blinding_keys[script];
+    if (value == key) return;
+    value = key;
+    m_dirty = true;
+}
+
+void DeviceCache::load()
+{
+    QFile file(m_path);
+    if (!file.open(QFile::ReadOnly)) return;
+
+    const QByteArray data = file.readAll();
+    if (data.size() < MAGIC.size() + 4 + MAC_SIZE || !data.startsWith(MAGIC)) {
+        qDebug() << "discard invalid device cache" << m_path;
+        return;
+    }
+    const quint32 version = qFromBigEndian<quint32>(data.constData() + MAGIC.size());
+    if (version != FORMAT_VERSION) {
+        qDebug() << "discard device cache version" << version << m_path;
+        return;
+    }
+    const QByteArray payload = data.mid(MAGIC.size() + 4 + MAC_SIZE);
+    if (data.mid(MAGIC.size() + 4, MAC_SIZE) != Mac(m_master_xpub, payload)) {
+        qDebug() << "discard device cache of another device or modified" << m_path;
+        return;
+    }
+    QCborParserError error;
+    const auto value = QCborValue::fromCbor(payload, &error);
+    if (error.error != QCborError::NoError || !value.isMap()) {
+        qDebug() << "discard corrupted device cache" << m_path << error.errorString();
+        return;
+    }
+    const auto map = value.toMap();
+    for (const auto& entry : map.value(QStringLiteral("xpubs")).toArray()) {
+        const auto pair = entry.toArray();
+        m_xpubs.insert(PathFromCbor(pair.at(0).toArray()), pair.at(1).toString());
+    }
+    for (const auto& entry : map.value(QStringLiteral("nonces")).toArray()) {
+        const auto pair = entry.toArray();
+        const auto key = pair.at(0).toByteArray();
+        if (m_nonces.contains(key)) continue;
+        m_nonces.insert(key, pair.at(1).toByteArray());
+        m_nonce_keys.enqueue(key);
+    }
+    while (m_nonce_keys.size() > MAX_NONCES) m_nonces.remove(m_nonce_keys.dequeue());
+    for (const auto& entry : map.value(QStringLiteral("blinding_keys")).toArray()) {
+        const auto pair = entry.toArray();
+        m_blinding_keys.insert(pair.at(0).toString(), pair.at(1).toByteArray());
+    }
+    qDebug() << "loaded device cache with" << m_xpubs.size() << "xpubs," << m_nonces.size() << "nonces and" << m_blinding_keys.size() << "blinding keys";
+}
+
+void DeviceCache::save()
+{
+    if (m_dirty) m_save_timer.start();
+}
+
+void DeviceCache::write()
+{
+    if (!m_dirty) return;
+
+    QCborArray xpubs;
+    for (auto i = m_xpubs.constBegin(); i != m_xpubs.constEnd(); ++i) {
+        xpubs.append(QCborArray{ PathToCbor(i.key()), i.value() });
+    }
+    // Oldest first, so that eviction order survives a reload
+    QCborArray nonces;
+    for (const auto& key : m_nonce_keys) {
+        nonces.append(QCborArray{ key, m_nonces.value(key) });
+    }
+    QCborArray blinding_keys;
+    for (auto i = m_blinding_keys.constBegin(); i != m_blinding_keys.constEnd(); ++i) {
+        blinding_keys.append(QCborArray{ i.key(), i.value() });
+    }
+    QCborMap map;
+    map.insert(QStringLiteral("xpubs"), xpubs);
+    map.insert(QStringLiteral("nonces"), nonces);
+    map.insert(QStringLiteral("blinding_keys"), blinding_keys);
+
+    const QByteArray payload = map.toCborValue().toCbor();
+    QByteArray header = MAGIC;
+    header.resize(MAGIC.size() + 4);
+    qToBigEndian<quint32>(FORMAT_VERSION, header.data() + MAGIC.size());
+    header.append(Mac(m_master_xpub, payload));
+
+    QSaveFile file(m_path);
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "failed to open device cache" << m_path << file.errorString();
+        return;
+    }
+    file.write(header);
+    file.write(payload);
+    if (!file.commit()) {
+        qWarning() << "failed to write device cache" << m_path << file.errorString();
+        return;
+    }
+    m_dirty = false;
+}
@@ -0,0 +1,71 @@
+#ifndef GREEN_DEVICECACHE_H
+#define GREEN_DEVICECACHE_H
+
+#include <QHash>
+#include <QMap>
+#include <QQueue>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+// Persistent cache of the data a hardware wallet derives deterministically
+// from its seed, shared by every device type. A cache is identified by the
+// network and the master key fingerprint. It is stored as CBOR after a
+// magic, a format version and an HMAC of the CBOR keyed by the master xpub
+// reported by the device, so entries of another device or edited entries
+// are discarded along with any version mismatch.
+// The file is not encrypted. Besides public keys it holds the Liquid
+// blinding nonces, ECDH secrets that unblind the amounts and assets of
+// the outputs they were derived for.
+class DeviceCache
+{
+public:
+    // Returns the cache of the device with the given master xpub, loaded
+    // from disk on first use, or nullptr if the xpub is invalid. Instances
+    // live until exit
+    static DeviceCache* get(const QString& network, const QString& master_xpub);
+
+    QString masterXPub() const { return m_master_xpub; }
+
+    // Whether a cached xpub was checked against the device since the cache
+    // was loaded, clear drops every entry read from disk
+    bool isVerified() const { return m_verified; }
+    void setVerified() { m_verified = true; }
+    void clear();
+
+    QString xpub(const QVector<uint32_t>& path) const { return m_xpubs.value(path); }
+    void setXPub(const QVector<uint32_t>& path, const QString& xpub);
+
+    // Liquid blinding nonces keyed by the output script and the sender pubkey,
+    // the oldest are dropped past MAX_NONCES
+    static const int MAX_NONCES = 10000;
+    QByteArray nonce(const QByteArray& pubkey, const QByteArray& script) const;
+    void setNonce(const QByteArray& pubkey, const QByteArray& script, const QByteArray& nonce);
+
+    // Liquid public blinding keys keyed by the hex output script, which GDK
+    // reports as blinding_script_hash, exactly as passed to the device
+    QByteArray blindingKey(const QString& script) const { return m_blinding_keys.value(script); }
+    void setBlindingKey(const QString& script, const QByteArray& key);
+
+    // Writes the cache to disk shortly if it changed, so that consecutive
+    // resolvers write it once, or on exit at the latest
+    void save();
+
+private:
+    DeviceCache(const QString& path, const QString& master_xpub);
+    void load();
+    void write();
+
+    const QString m_path;
+    const QString m_master_xpub;
+    QMap<QVector<uint32_t>, QString> m_xpubs;
+    QHash<QByteArray, QByteArray> m_nonces;
+    // Nonce keys, oldest first
+    QQueue<QByteArray> m_nonce_keys;
+    QHash<QString, QByteArray> m_blinding_keys;
+    bool m_dirty{false};
+    bool m_verified{false};
+    QTimer m_save_timer;
+};
+
+#endif // GREEN_DEVICECACHE_H
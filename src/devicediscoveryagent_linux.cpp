@@ -16,45 +16,45 @@
 #include <linux/hidraw.h>
 #include <unistd.h>
 
+#include <cerrno>
+#include <cstring>
+
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+
+// Add and remove events received within this interval are coalesced
+const int DEBOUNCE_INTERVAL = 250;
+
+} // namespace
+
 DeviceDiscoveryAgentPrivate::DeviceDiscoveryAgentPrivate(DeviceDiscoveryAgent *q)
     : q(q)
+    , m_thread(new QThread)
+    , m_context(new QObject)
 {
-    m_udev = udev_new();
-    Q_ASSERT(m_udev);
-    m_monitor = udev_monitor_new_from_netlink(m_udev, "udev");
-    Q_ASSERT(m_monitor);
-    int res = udev_monitor_filter_add_match_subsystem_devtype(m_monitor, "hidraw", nullptr);
-    Q_ASSERT(res >= 0);
-    res = udev_monitor_enable_receiving(m_monitor);
-    Q_ASSERT(res >= 0);
-
-    m_notifier = new QSocketNotifier(udev_monitor_get_fd(m_monitor), QSocketNotifier::Read);
-    m_notifier->setEnabled(true);
-    QObject::connect(m_notifier, &QSocketNotifier::activated, [this](int) {
-        udev_device* device = udev_monitor_receive_device(m_monitor);
-        qDebug() << "monitor: " << udev_device_get_action(device) << udev_device_get_subsystem(device) << udev_device_get_driver(device);
-
-        auto action = udev_device_get_action(device);
-        Q_ASSERT(action);
-        if (strcmp(action, "add") == 0) addDevice(device);
-        if (strcmp(action, "remove") == 0) removeDevice(device);
-    });
-    auto enumerate = udev_enumerate_new(m_udev);
-    udev_enumerate_add_match_subsystem(enumerate, "hidraw");
-    udev_enumerate_scan_devices(enumerate);
-    auto entry = udev_enumerate_get_list_entry(enumerate);
-    while (entry) {
-        udev_device* device = udev_device_new_from_syspath(m_udev, udev_list_entry_get_name(entry));
-        addDevice(device);
-        entry = udev_list_entry_get_next(entry);
-    }
-    udev_enumerate_unref(enumerate);
+    // Enumeration, monitoring and probing don't block the GUI thread
+    m_thread->setObjectName("device-discovery");
+    m_context->moveToThread(m_thread);
+    m_thread->start();
+    QMetaObject::invokeMethod(m_context, [this] { start(); });
 }
 
 DeviceDiscoveryAgentPrivate::~DeviceDiscoveryAgentPrivate()
 {
-    udev_monitor_unref(m_monitor);
-    udev_unref(m_udev);
+    QMetaObject::invokeMethod(m_context, [this] { stop(); }, Qt::BlockingQueuedConnection);
+    m_thread->quit();
+    m_thread->wait();
+    delete m_context;
+    delete m_thread;
+
+    for (auto impl : m_devices) {
+        DeviceManager::instance()->removeDevice(impl->q);
+        delete impl->q;
+    }
 }
 
 static void DumpDevice(udev_device* device)
@@ -88,148 +88,274 @@ static bool GetDevPath(udev_device* handle, QString& devpath)
     return true;
 }
 
-void DeviceDiscoveryAgentPrivate::addDevice(udev_device* handle)
+void DeviceDiscoveryAgentPrivate::start()
 {
-    auto hid_dev = udev_device_get_parent_with_subsystem_devtype(handle, "usb", "usb_device");
-    if (!hid_dev) return;
+    m_udev = udev_new();
+    Q_ASSERT(m_udev);
+    m_monitor = udev_monitor_new_from_netlink(m_udev, "udev");
+    Q_ASSERT(m_monitor);
+    int res = udev_monitor_filter_add_match_subsystem_devtype(m_monitor, "hidraw", nullptr);
+    Q_ASSERT(res >= 0);
+    res = udev_monitor_enable_receiving(m_monitor);
+    Q_ASSERT(res >= 0);
 
+    m_debounce = new QTimer(m_context);
+    m_debounce->setSingleShot(true);
+    m_debounce->setInterval(DEBOUNCE_INTERVAL);
+    QObject::connect(m_debounce, &QTimer::timeout, m_context, [this] { flush(); });
 
-    uint32_t vendor_id = QString::fromLocal8Bit(udev_device_get_sysattr_value(hid_dev, "idVendor")).toUInt(nullptr, 16);
-    uint32_t product_id = QString::fromLocal8Bit(udev_device_get_sysattr_value(hid_dev, "idProduct")).toUInt(nullptr, 16);
+    m_notifier = new QSocketNotifier(udev_monitor_get_fd(m_monitor), QSocketNotifier::Read, m_context);
+    QObject::connect(m_notifier, &QSocketNotifier::activated, m_context, [this] {
+        udev_device* device = udev_monitor_receive_device(m_monitor);
+        if (!device) return;
+        const char* action = udev_device_get_action(device);
+        QString devpath;
+        if (action && GetDevPath(device, devpath)) {
+            qDebug() << "monitor:" << action << devpath;
+            if (strcmp(action, "add") == 0) m_pending.insert(devpath, true);
+            if (strcmp(action, "remove") == 0) m_pending.insert(devpath, false);
+            m_debounce->start();
+        }
+        udev_device_unref(device);
+    });
 
-    Device::Type device_type = Device::typefromVendorAndProduct(vendor_id, product_id);
-    if (device_type == Device::NoType) return;
+    QElapsedTimer timer;
+    timer.start();
+    auto enumerate = udev_enumerate_new(m_udev);
+    udev_enumerate_add_match_subsystem(enumerate, "hidraw");
+    udev_enumerate_scan_devices(enumerate);
+    udev_list_entry* entry;
+    udev_list_entry_foreach(entry, udev_enumerate_get_list_entry(enumerate)) {
+        udev_device* device = udev_device_new_from_syspath(m_udev, udev_list_entry_get_name(entry));
+        QString devpath;
+        if (device && GetDevPath(device, devpath)) m_pending.insert(devpath, true);
+        if (device) udev_device_unref(device);
+    }
+    udev_enumerate_unref(enumerate);
+    flush();
+    qDebug() << "device discovery took" << timer.elapsed() << "ms";
+}
 
-    int fd = open(udev_device_get_devnode(handle), O_RDWR); //|O_NONBLOCK);
-    if (fd < 0) return;
+void DeviceDiscoveryAgentPrivate::stop()
+{
+    delete m_notifier;
+    m_notifier = nullptr;
+    delete m_debounce;
+    m_debounce = nullptr;
+    udev_monitor_unref(m_monitor);
+    m_monitor = nullptr;
+    udev_unref(m_udev);
+    m_udev = nullptr;
+    // Devices probed but not yet taken by the GUI thread
+    for (auto i = m_pending_fds.begin(); i != m_pending_fds.end(); ++i) close(i.value());
+    m_pending_fds.clear();
+}
 
-#if 1
-    /* Get the report descriptor */
-    int res, desc_size = 0;
-    /* Get Report Descriptor Size */
-    res = ioctl(fd, HIDIOCGRDESCSIZE, &desc_size);
-    if (res < 0) {
-        perror("HIDIOCGRDESCSIZE");
-     }
+void DeviceDiscoveryAgentPrivate::flush()
+{
+    const auto pending = m_pending;
+    m_pending.clear();
+    for (auto i = pending.begin(); i != pending.end(); ++i) {
+        const QString devpath = i.key();
+        if (!i.value()) {
+            if (!m_reported.remove(devpath)) continue;
+            QMetaObject::invokeMethod(q, [this, devpath] { removeDevice(devpath); });
+            continue;
+        }
+        if (m_reported.contains(devpath)) continue;
+        udev_device* device = udev_device_new_from_syspath(m_udev, ("/sys" + devpath).toLocal8Bit().constData());
+        if (!device) continue;
+        Device::Type type;
+        const int fd = probe(devpath, device, type);
+        udev_device_unref(device);
+        if (fd < 0) continue;
+        m_reported.insert(devpath);
+        m_pending_fds.insert(devpath, fd);
+        QMetaObject::invokeMethod(q, [this, devpath, fd, type] {
+            addDevice(devpath, fd, type);
+        });
+    }
+}
+
+int DeviceDiscoveryAgentPrivate::probe(const QString& devpath, udev_device* handle, Device::Type& type)
+{
+    auto usb_dev = udev_device_get_parent_with_subsystem_devtype(handle, "usb", "usb_device");
+    if (!usb_dev) return -1;
+
+    const uint32_t vendor_id = QString::fromLocal8Bit(udev_device_get_sysattr_value(usb_dev, "idVendor")).toUInt(nullptr, 16);
+    const uint32_t product_id = QString::fromLocal8Bit(udev_device_get_sysattr_value(usb_dev, "idProduct")).toUInt(nullptr, 16);
+    type = Device::typefromVendorAndProduct(vendor_id, product_id);
+    if (type == Device::NoType) return -1;
+
+    // Interfaces known not to be the Ledger transport are not opened again
+    const auto cached = m_probes.find(devpath);
+    if (cached != m_probes.end() && cached->vendor_id == vendor_id && cached->product_id == product_id && !cached->supported) return -1;
 
-    struct hidraw_report_descriptor rpt_desc;
+    const char* devnode = udev_device_get_devnode(handle);
+    if (!devnode) return -1;
+    const int fd = open(devnode, O_RDWR | O_NONBLOCK);
+    if (fd < 0) return -1;
 
-    memset(&rpt_desc, 0x0, sizeof(rpt_desc));
-    /* Get Report Descriptor */
-    rpt_desc.size = desc_size;
-    res = ioctl(fd, HIDIOCGRDESC, &rpt_desc);
-    if (res < 0) {
-        perror("HIDIOCGRDESC");
+    // The Ledger transport interface has the vendor usage page 0xffa0
+    bool supported = false;
+    int desc_size = 0;
+    if (ioctl(fd, HIDIOCGRDESCSIZE, &desc_size) < 0) {
+        perror("HIDIOCGRDESCSIZE");
     } else {
-        auto bb = QByteArray::fromRawData((const char*) rpt_desc.value, rpt_desc.size);
-        qDebug() << "B1=" << uint8_t(bb.at(1)) << "B2=" << uint8_t(bb.at(2)) << uint8_t(0xfa) << uint8_t(0xff);
-        if (uint8_t(bb.at(1)) != uint8_t(0xa0) || uint8_t(bb.at(2)) != uint8_t(0xff)) return;
-
-        qDebug() << "REPORT DESCRIPTOR = " << bb.toHex();
-        /* Determine if this device uses numbered reports. */
-//                dev->uses_numbered_reports =
-//                    uses_numbered_reports(rpt_desc.value,
-//                                          rpt_desc.size);
+        struct hidraw_report_descriptor rpt_desc;
+        memset(&rpt_desc, 0x0, sizeof(rpt_desc));
+        rpt_desc.size = desc_size;
+        if (ioctl(fd, HIDIOCGRDESC, &rpt_desc) < 0) {
+            perror("HIDIOCGRDESC");
+        } else {
+            supported = rpt_desc.size > 2 && rpt_desc.value[1] == 0xa0 && rpt_desc.value[2] == 0xff;
+        }
+    }
+    m_probes.insert(devpath, { vendor_id, product_id, supported });
+    if (!supported) {
+        close(fd);
+        return -1;
     }
+    return fd;
+}
 
-#endif
-    QString devpath;
-    if (!GetDevPath(handle, devpath)) return;
+void DeviceDiscoveryAgentPrivate::addDevice(const QString& devpath, int fd, Device::Type type)
+{
+    QMetaObject::invokeMethod(m_context, [this, devpath] { m_pending_fds.remove(devpath); });
 
     auto impl = new DevicePrivateImpl;
-    impl->handle = handle;
     impl->fd = fd;
-    impl->m_type = device_type;
+    impl->m_type = type;
     auto device = new LedgerDevice(impl);
 
+    impl->notifier = new QSocketNotifier(fd, QSocketNotifier::Read);
+    QObject::connect(impl->notifier, &QSocketNotifier::activated, [impl] { impl->readReports(); });
+
     m_devices.insert(devpath, impl);
     DeviceManager::instance()->addDevice(device);
-
-    auto notifier = new QSocketNotifier(fd, QSocketNotifier::Read);
-    notifier->setEnabled(true);
-    QObject::connect(notifier, &QSocketNotifier::activated, [impl, fd, notifier] {
-        char b[64];
-        auto x = read(fd, (void*) b, 64);
-        if (x == 64) impl->inputReport(QByteArray::fromRawData(b, 64));
-        else notifier->deleteLater();
-    });
-    // udev_device_unref(handle);
 }
 
-void DeviceDiscoveryAgentPrivate::removeDevice(udev_device* handle)
+void DeviceDiscoveryAgentPrivate::removeDevice(const QString& devpath)
 {
-    QString devpath;
-    if (!GetDevPath(handle, devpath)) return;
     DevicePrivateImpl* impl = m_devices.take(devpath);
     if (!impl) return;
     DeviceManager::instance()->removeDevice(impl->q);
     delete impl->q;
 }
 
-QList<QByteArray> transport(const QByteArray& data) {
-    QList<QByteArray> packets;
-    int offset = 0;
-    //qDebug() << "wrapping" << data.toHex();
-    while (offset < data.size()) {
-        QByteArray result;
-        auto d = data.mid(offset, 64 - (packets.empty() ? 7 : 5));
-        offset += d.size();
-        QDataStream stream(&result, QIODevice::WriteOnly);
-        stream << uint16_t(0x0101) << uint8_t(0x05) << uint16_t(packets.size());
-        if (packets.empty()) stream << uint16_t(data.length());
-        result.append(d);
-        //qDebug() << "  packet " << result.toHex() << result.size();
-        Q_ASSERT(result.length() <= 64);
-        result = result.leftJustified(64, 0x0);
-        packets.append(result);
+DevicePrivateImpl::~DevicePrivateImpl()
+{
+    delete notifier;
+    if (fd >= 0) close(fd);
+}
+
+bool DevicePrivateImpl::send(DeviceCommand* command)
+{
+    // hidraw takes a single report per write
+    const int count = m_writer.frame(command->payload());
+    for (int i = 0; i < count; ++i) {
+        const int res = write(fd, m_writer.report(i), HIDFrameWriter::REPORT_SIZE + 1);
+        if (res != HIDFrameWriter::REPORT_SIZE + 1) return false;
     }
-    return packets;
+    requestSent();
+    return true;
 }
 
 void DevicePrivateImpl::exchange(DeviceCommand* command)
 {
     const bool send = queue.empty();
-    if (send) {
-        const auto payload = command->payload();
-        for (const auto& packet : transport(payload)) {
-            QByteArray report;
-            report.append(uint8_t(0));
-            report.append(packet);
-            int res = write(fd, report.constData(), report.size());
-            Q_ASSERT(res == report.size());
-        }
+    enqueue(command);
+    if (send && !this->send(command)) {
+        // Callers connect to the command after exchange returns
+        if (dequeue()) QMetaObject::invokeMethod(command, "error", Qt::QueuedConnection);
     }
-    queue.enqueue(command);
 }
 
-void DevicePrivateImpl::inputReport(const QByteArray& data)
+void DevicePrivateImpl::readReports()
 {
-    if (queue.empty()) {
-        qDebug() << "READ UNKNOWN REPORT" << data.toHex();
-        return;
+    // Drain every pending report, reports are 64 bytes and hidraw returns
+    // one per read. Reads are bounded, short ones included, so that a
+    // chatty device can't starve the event loop, the notifier fires again
+    // for the remainder.
+    const int size = HIDFrameWriter::REPORT_SIZE;
+    if (m_reports.isEmpty()) m_reports.resize(MAX_REPORTS * size);
+    int count = 0;
+    int error = 0;
+    for (int reads = 0; reads < MAX_REPORTS; ++reads) {
+        const ssize_t res = read(fd, m_reports.data() + count * size, size);
+        if (res == size) {
+            ++count;
+        } else if (res > 0) {
+            qWarning() << "discarding short HID report of" << res << "bytes";
+        } else if (res < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (res == 0) error = ENODEV;
+            else if (errno != EAGAIN && errno != EWOULDBLOCK) error = errno;
+            break;
+        }
+    }
+
+    // Handling a response can end up deleting the device, and this with it
+    QPointer<LedgerDevice> device(q);
+    for (int i = 0; i < count; ++i) {
+        const char* report = m_reports.constData() + i * size;
+        if (queue.empty()) {
+            qDebug() << "READ UNKNOWN REPORT" << QByteArray::fromRawData(report, size).toHex();
+            continue;
+        }
+        reportReceived();
+        switch (m_reader.read(report, size)) {
+        case HIDFrameReader::Incomplete:
+            continue;
+        case HIDFrameReader::Invalid:
+            qWarning() << "invalid HID report" << QByteArray::fromRawData(report, size).toHex();
+            m_reader.reset();
+            emit queue.head()->error();
+            if (!device) return;
+            next();
+            continue;
+        case HIDFrameReader::Complete:
+            inputResponse(m_reader.response());
+            if (!device) return;
+            m_reader.reset();
+            continue;
+        }
     }
-    Q_ASSERT(!queue.empty());
-    QDataStream stream(data);
+
+    if (error != 0) {
+        // The device is gone or unusable, udev reports the removal
+        qWarning() << "HID read failed:" << strerror(error);
+        notifier->setEnabled(false);
+        m_reader.reset();
+        while (!queue.empty()) {
+            if (auto command = dequeue()) QMetaObject::invokeMethod(command, "error", Qt::QueuedConnection);
+        }
+        queueDrained();
+    }
+}
+
+void DevicePrivateImpl::inputResponse(const QByteArray& response)
+{
+    QPointer<LedgerDevice> device(q);
     auto command = queue.head();
-    int r = command->readHIDReport(q, stream);
-    if (r == 2) return;
+    const int r = command->readHIDReport(q, response);
+    if (!device) return;
+    responseReceived();
     if (r == 1) qWarning("command failed");
-    queue.dequeue();
-    if (!queue.empty()) {
-        command = queue.head();
-        const auto payload = command->payload();
-        for (const auto& packet : transport(payload)) {
-            QByteArray report;
-            report.append(uint8_t(0));
-            report.append(packet);
-            int res = write(fd, report.constData(), report.size());
-            if (res < 0) {
-                qDebug() << "FAILED";
-                delete command;
-                return;
-            }
-        }
+    next();
+}
+
+void DevicePrivateImpl::next()
+{
+    dequeue();
+    while (!queue.empty()) {
+        auto command = queue.head();
+        if (send(command)) break;
+        qDebug() << "FAILED";
+        if (dequeue()) QMetaObject::invokeMethod(command, "error", Qt::QueuedConnection);
     }
+    if (queue.empty()) queueDrained();
 }
 
 #endif // Q_OS_LINUX
@@ -6,18 +6,33 @@
 #ifdef Q_OS_LINUX
 #include "device_p.h"
 
+#include <QHash>
+#include <QMap>
+#include <QSet>
 #include <QSocketNotifier>
 #include <libudev.h>
 
+QT_FORWARD_DECLARE_CLASS(QThread)
+QT_FORWARD_DECLARE_CLASS(QTimer)
+
 class DeviceDiscoveryAgent;
 
 class DevicePrivateImpl : public DevicePrivate
 {
 public:
-    udev_device* handle;
-    int fd;
+    ~DevicePrivateImpl();
+    int fd{-1};
+    QSocketNotifier* notifier{nullptr};
+    bool send(DeviceCommand* command);
     void exchange(DeviceCommand* command) override;
-    void inputReport(const QByteArray& data);
+    void readReports();
+    void inputResponse(const QByteArray& response);
+    void next();
+
+    // Maximum reports read per notifier activation
+    static const int MAX_REPORTS = 32;
+    QByteArray m_reports;
+    HIDFrameReader m_reader;
 };
 
 class DeviceDiscoveryAgentPrivate
@@ -26,14 +41,35 @@ public:
     DeviceDiscoveryAgentPrivate(DeviceDiscoveryAgent* q);
     ~DeviceDiscoveryAgentPrivate();
 
-    void addDevice(udev_device* handle);
-    void removeDevice(udev_device* handle);
-
 private:
+    struct Probe {
+        uint32_t vendor_id;
+        uint32_t product_id;
+        bool supported;
+    };
+
+    // Run in the discovery thread
+    void start();
+    void stop();
+    void flush();
+    int probe(const QString& devpath, udev_device* handle, Device::Type& type);
+
+    // Run in the GUI thread
+    void addDevice(const QString& devpath, int fd, Device::Type type);
+    void removeDevice(const QString& devpath);
+
     DeviceDiscoveryAgent* const q;
+    QThread* const m_thread;
+    QObject* const m_context;
     udev* m_udev{nullptr};
     udev_monitor* m_monitor{nullptr};
     QSocketNotifier* m_notifier{nullptr};
+    QTimer* m_debounce{nullptr};
+    // Devpath to latest action since the last flush, true for add
+    QMap<QString, bool> m_pending;
+    QSet<QString> m_reported;
+    QHash<QString, Probe> m_probes;
+    QMap<QString, int> m_pending_fds;
     QMap<QString, DevicePrivateImpl*> m_devices;
 };
 
@@ -162,74 +162,46 @@ DeviceDiscoveryAgentPrivate::~DeviceDiscoveryAgentPrivate()
 }
 
 
-QList<QByteArray> transport(const QByteArray& data) {
-    QList<QByteArray> packets;
-    int offset = 0;
-    //qDebug() << "wrapping" << data.toHex();
-    while (offset < data.size()) {
-        QByteArray result;
-        auto d = data.mid(offset, 64 - (packets.empty() ? 7 : 5));
-        offset += d.size();
-        QDataStream stream(&result, QIODevice::WriteOnly);
-        stream << uint16_t(0x0101) << uint8_t(0x05) << uint16_t(packets.size());
-        if (packets.empty()) stream << uint16_t(data.length());
-        result.append(d);
-        //qDebug() << "  packet " << result.toHex() << result.size();
-        Q_ASSERT(result.length() <= 64);
-        result = result.leftJustified(64, 0x0);
-        packets.append(result);
+bool DevicePrivateImpl::send(DeviceCommand* command)
+{
+    const int count = m_writer.frame(command->payload());
+    for (int i = 0; i < count; ++i) {
+        // Skip the report id, it's given separately
+        const auto report = reinterpret_cast<const uint8_t*>(m_writer.report(i)) + 1;
+        auto res = IOHIDDeviceSetReport(handle, kIOHIDReportTypeOutput, 0, report, HIDFrameWriter::REPORT_SIZE);
+        if (res != kIOReturnSuccess) return false;
     }
-    return packets;
+    requestSent();
+    return true;
 }
 
 void DevicePrivateImpl::exchange(DeviceCommand* command)
 {
     const bool send = queue.empty();
-    if (send) {
-        const auto payload = command->payload();
-        //qDebug() << "send " << payload.toHex();
-        for (const auto& packet : transport(payload)) {
-            //qDebug() << "send packet " << packet.toHex();
-            auto res = IOHIDDeviceSetReport(handle, kIOHIDReportTypeOutput, 0, (const uint8_t*) packet.constData(), packet.size());
-            if (res != kIOReturnSuccess) {
-                emit command->error();
-                return;
-            }
-        }
-        //qDebug() << "send done";
+    enqueue(command);
+    if (send && !this->send(command)) {
+        // Callers connect to the command after exchange returns
+        if (dequeue()) QMetaObject::invokeMethod(command, "error", Qt::QueuedConnection);
     }
-    queue.enqueue(command);
 }
 
 void DevicePrivateImpl::inputReport(const QByteArray& data)
 {
-    //qDebug() << "read hid" << data.toHex();
     Q_ASSERT(!queue.empty());
-    QDataStream stream(data);
+    reportReceived();
     auto command = queue.head();
-    int r = command->readHIDReport(q, stream);
+    int r = command->readHIDReport(q, data.constData(), data.size());
     if (r == 2) return;
-    if (r == 1) {
-        qWarning("command failed");
-        qDebug() << command << command->objectName();
-        delete command;
-    }
-    queue.dequeue();
-    if (!queue.empty()) {
-        //qDebug() << "sending next command";
+    responseReceived();
+    // Failed commands are released by their owner, possibly to the pool
+    if (r == 1) qWarning("command failed");
+    dequeue();
+    while (!queue.empty()) {
         command = queue.head();
-        const auto payload = command->payload();
-        //qDebug() << "send " << payload.toHex();
-        for (const auto& packet : transport(payload)) {
-            //qDebug() << "send packet " << packet.toHex();
-            auto res = IOHIDDeviceSetReport(handle, kIOHIDReportTypeOutput, 0, (const uint8_t*) packet.constData(), packet.size());
-            if (res != kIOReturnSuccess) {
-                emit command->error();
-                delete command;
-                return;
-            }
-        }
+        if (send(command)) break;
+        if (dequeue()) QMetaObject::invokeMethod(command, "error", Qt::QueuedConnection);
     }
+    if (queue.empty()) queueDrained();
 }
 
 #endif // Q_OS_MAC
@@ -18,6 +18,7 @@ class DevicePrivateImpl : public DevicePrivate
 public:
     IOHIDDeviceRef handle;
     //int32_t m_unique_id;
+    bool send(DeviceCommand* command);
     void exchange(DeviceCommand *command) override;
     void inputReport(const QByteArray& data);
 };
@@ -121,37 +121,25 @@ void DeviceDiscoveryAgentPrivate::addDevice(hid_device_info* info)
     DeviceManager::instance()->addDevice(d);
 }
 
-QList<QByteArray> transport(const QByteArray& data) {
-    QList<QByteArray> packets;
-    int offset = 0;
-    while (offset < data.size()) {
-        QByteArray result;
-        auto d = data.mid(offset, 64 - (packets.empty() ? 7 : 5));
-        offset += d.size();
-        QDataStream stream(&result, QIODevice::WriteOnly);
-        stream << uint16_t(0x0101) << uint8_t(0x05) << uint16_t(packets.size());
-        if (packets.empty()) stream << uint16_t(data.length());
-        result.append(d);
-        Q_ASSERT(result.length() <= 64);
-        result = result.leftJustified(64, 0x0);
-        packets.append(result);
+bool DevicePrivateImpl::send(DeviceCommand* command)
+{
+    const int count = m_writer.frame(command->payload());
+    for (int i = 0; i < count; ++i) {
+        const auto report = reinterpret_cast<const unsigned char*>(m_writer.report(i));
+        if (hid_write(dev, report, HIDFrameWriter::REPORT_SIZE + 1) < 0) return false;
     }
-    return packets;
+    requestSent();
+    return true;
 }
 
 void DevicePrivateImpl::exchange(DeviceCommand *command)
 {
     const bool send = queue.empty();
-    if (send) {
-        const auto payload = command->payload();
-        for (const auto& packet : transport(payload)) {
-            QByteArray report;
-            report.append(uint8_t(0));
-            report.append(packet);
-            hid_write(dev, (unsigned char*) report.constData(), report.size());
-        }
+    enqueue(command);
+    if (send && !this->send(command)) {
+        // Callers connect to the command after exchange returns
+        if (dequeue()) QMetaObject::invokeMethod(command, "error", Qt::QueuedConnection);
     }
-    queue.enqueue(command);
 }
 
 void DevicePrivateImpl::inputReport(const QByteArray& data)
@@ -160,29 +148,19 @@ void DevicePrivateImpl::inputReport(const QByteArray& data)
         // qDebug() << "READ UNKNOWN REPORT" << data.toHex();
         return;
     }
-    Q_ASSERT(!queue.empty());
-    QDataStream stream(data);
+    reportReceived();
     auto command = queue.head();
-    int r = command->readHIDReport(q, stream);
+    int r = command->readHIDReport(q, data.constData(), data.size());
     if (r == 2) return;
+    responseReceived();
     if (r == 1) qWarning("command failed");
-    queue.dequeue();
-    // qDebug() << "input report done, queue size = " << queue.size();
-    if (!queue.empty()) {
-        //qDebug() << "sending next command";
+    dequeue();
+    while (!queue.empty()) {
         command = queue.head();
-        const auto payload = command->payload();
-        //qDebug() << "send " << payload.toHex();
-        for (const auto& packet : transport(payload)) {
-            qDebug() << "send packet " << packet.toHex();
-            //auto res = IOHIDDeviceSetReport(handle, kIOHIDReportTypeOutput, 0, (const uint8_t*) packet.constData(), packet.size());
-            QByteArray report;
-            report.append(uint8_t(0));
-            report.append(packet);
-            hid_write(dev, (unsigned char*) report.constData(), report.size());
-        }
-        //qDebug() << "send done";
+        if (send(command)) break;
+        if (dequeue()) QMetaObject::invokeMethod(command, "error", Qt::QueuedConnection);
     }
+    if (queue.empty()) queueDrained();
 }
 
 #endif // Q_OS_WIN
@@ -22,6 +22,7 @@ class DevicePrivateImpl : public DevicePrivate
 public:
     hid_device* dev;
     QString id;
+    bool send(DeviceCommand* command);
     void exchange(DeviceCommand *command) override;
     void inputReport(const QByteArray& data);
 };
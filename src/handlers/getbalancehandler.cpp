@@ -8,6 +8,12 @@ GetBalanceHandler::GetBalanceHandler(Account* account)
     : Handler(account->wallet())
     , m_account(account)
 {
+    setLane(Session::Lane::Background);
+}
+
+QByteArray GetBalanceHandler::key() const
+{
+    return "get_balance:" + QByteArray::number(m_account->pointer());
 }
 
 void GetBalanceHandler::call(GA_session* session, GA_auth_handler** auth_handler)
@@ -7,6 +7,7 @@ class GetBalanceHandler : public Handler
 {
     Account* const m_account;
     void call(GA_session* session, GA_auth_handler** auth_handler) override;
+    QByteArray key() const override;
 public:
     GetBalanceHandler(Account* account);
 };
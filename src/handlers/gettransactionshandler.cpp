@@ -15,12 +15,18 @@ void GetTransactionsHandler::call(GA_session *session, GA_auth_handler **auth_ha
     Q_ASSERT(err == GA_OK);
 }
 
+QByteArray GetTransactionsHandler::key() const
+{
+    return "get_transactions:" + QByteArray::number(m_subaccount) + ":" + QByteArray::number(m_first) + ":" + QByteArray::number(m_count);
+}
+
 GetTransactionsHandler::GetTransactionsHandler(int subaccount, int first, int count, Wallet *wallet)
     : Handler(wallet)
     , m_subaccount(subaccount)
     , m_first(first)
     , m_count(count)
 {
+    setLane(Session::Lane::Background);
 }
 
 QJsonArray GetTransactionsHandler::transactions() const
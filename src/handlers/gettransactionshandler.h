@@ -9,6 +9,7 @@ class GetTransactionsHandler : public Handler
     int m_first;
     int m_count;
     void call(GA_session* session, GA_auth_handler** auth_handler) override;
+    QByteArray key() const override;
 public:
     GetTransactionsHandler(int subaccount, int first, int count, Wallet *wallet);
     QJsonArray transactions() const;
@@ -10,6 +10,9 @@
 
 #include <gdk.h>
 
+// In flight handlers by session and key, only accessed from the GUI thread
+static QHash<QPair<Session*, QByteArray>, Handler*> g_in_flight;
+
 Handler::Handler(Wallet* wallet)
     : QObject(wallet)
     , m_wallet(wallet)
@@ -18,6 +21,13 @@ Handler::Handler(Wallet* wallet)
 
 Handler::~Handler()
 {
+    if (!m_key.isEmpty()) {
+        const auto key = qMakePair(m_wallet->m_session, m_key);
+        if (g_in_flight.value(key) == this) g_in_flight.remove(key);
+        for (auto follower : m_followers) {
+            if (follower) follower->fail();
+        }
+    }
     if (m_auth_handler) GA_destroy_auth_handler(m_auth_handler);
 }
 
@@ -26,10 +36,32 @@ Wallet* Handler::wallet() const
     return m_wallet;
 }
 
+void Handler::setLane(Session::Lane lane)
+{
+    Q_ASSERT(!m_context);
+    m_lane = lane;
+}
+
 void Handler::exec()
 {
     Q_ASSERT(!m_auth_handler);
-    QMetaObject::invokeMethod(m_wallet->m_session->m_context, [this] {
+    Q_ASSERT(!m_context);
+
+    m_key = key();
+    if (!m_key.isEmpty()) {
+        const auto key = qMakePair(m_wallet->m_session, m_key);
+        auto leader = g_in_flight.value(key);
+        m_generation = m_wallet->m_session->generation();
+        if (leader && leader->m_generation == m_generation) return join(leader);
+        // A stale leader keeps its followers but is no longer joined
+        g_in_flight.insert(key, this);
+        connect(this, &Handler::done, this, [this] { settle(true); });
+        connect(this, &Handler::error, this, [this] { settle(false); });
+    }
+
+    // All steps of this handler run on the same lane
+    m_context = m_wallet->m_session->context(m_lane);
+    QMetaObject::invokeMethod(m_context, [this] {
         call(m_wallet->m_session->m_session, &m_auth_handler);
         if (m_auth_handler) {
             step();
@@ -39,6 +71,29 @@ void Handler::exec()
     }, Qt::QueuedConnection);
 }
 
+void Handler::join(Handler* leader)
+{
+    Q_ASSERT(leader != this);
+    leader->m_followers.append(this);
+}
+
+void Handler::settle(bool success)
+{
+    const auto key = qMakePair(m_wallet->m_session, m_key);
+    if (g_in_flight.value(key) == this) g_in_flight.remove(key);
+    const auto followers = m_followers;
+    m_followers.clear();
+    for (auto follower : followers) {
+        if (!follower) continue;
+        follower->setResult(m_result);
+        if (success) {
+            emit follower->done();
+        } else {
+            emit follower->error();
+        }
+    }
+}
+
 void Handler::fail()
 {
     setResult({{ "status", "error" }});
@@ -118,7 +173,7 @@ void Handler::request(const QByteArray& method)
     Q_ASSERT(m_result.value("status").toString() == "request_code");
     int res = GA_auth_handler_request_code(m_auth_handler, method.data());
     Q_ASSERT(res == GA_OK);
-    QMetaObject::invokeMethod(m_wallet->m_session->m_context, [this] {
+    QMetaObject::invokeMethod(m_context, [this] {
         step();
     });
 }
@@ -177,7 +232,7 @@ void Handler::resolve(const QByteArray& data)
     Q_ASSERT(m_auth_handler);
     int res = GA_auth_handler_resolve_code(m_auth_handler, data.constData());
     Q_ASSERT(res == GA_OK);
-    QMetaObject::invokeMethod(m_wallet->m_session->m_context, [this] {
+    QMetaObject::invokeMethod(m_context, [this] {
         step();
     });
 }
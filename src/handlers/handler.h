@@ -5,6 +5,8 @@
 #include <QObject>
 #include <QJsonObject>
 
+#include "session.h"
+
 QT_FORWARD_DECLARE_CLASS(Resolver)
 QT_FORWARD_DECLARE_CLASS(TwoFactorResolver)
 QT_FORWARD_DECLARE_CLASS(Wallet)
@@ -23,6 +25,8 @@ public:
     Handler(Wallet* wallet);
     virtual ~Handler();
     Wallet* wallet() const;
+    Session::Lane lane() const { return m_lane; }
+    void setLane(Session::Lane lane);
     void exec();
     void fail();
     const QJsonObject& result() const;
@@ -37,16 +41,29 @@ signals:
     void requestCode();
     void invalidCode();
     void resolver(Resolver* resolver);
+protected:
+    // Handlers with the same non empty key in the same session are
+    // deduplicated: while one is in flight, later ones join it and
+    // receive its result instead of calling GDK again. Only leaders started
+    // since the last session notification are joined.
+    virtual QByteArray key() const { return {}; }
 private:
     virtual void call(GA_session* session, GA_auth_handler** auth_handler) = 0;
     void step();
+    void join(Handler* leader);
+    void settle(bool success);
     Resolver* createResolver(const QJsonObject& result);
     void setResult(const QJsonObject &result);
 private:
     Wallet* const m_wallet;
+    Session::Lane m_lane{Session::Lane::Interactive};
+    QObject* m_context{nullptr};
     GA_auth_handler* m_auth_handler{nullptr};
     TwoFactorResolver* m_two_factor_resolver{nullptr};
     QJsonObject m_result;
+    QByteArray m_key;
+    int m_generation{0};
+    QList<QPointer<Handler>> m_followers;
 };
 
 #endif // GREEN_HANDLER_H
@@ -0,0 +1,83 @@
+#include "hidframing.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+namespace {
+
+const quint16 CHANNEL = 0x0101;
+const quint8 TAG_APDU = 0x05;
+const int HEADER_SIZE = 5;
+
+} // namespace
+
+int HIDFrameWriter::frame(const QByteArray& apdu)
+{
+    // The first report also has the 2 byte APDU length
+    const int first = REPORT_SIZE - HEADER_SIZE - 2;
+    const int next = REPORT_SIZE - HEADER_SIZE;
+    m_count = apdu.size() <= first ? 1 : 1 + (apdu.size() - first + next - 1) / next;
+
+    const int size = m_count * (REPORT_SIZE + 1);
+    if (m_buffer.size() < size) m_buffer.resize(size);
+    std::memset(m_buffer.data(), 0, size);
+
+    const char* data = apdu.constData();
+    int remaining = apdu.size();
+    for (int index = 0; index < m_count; ++index) {
+        uchar* report = reinterpret_cast<uchar*>(m_buffer.data()) + index * (REPORT_SIZE + 1);
+        // report[0] is the report id
+        uchar* header = report + 1;
+        qToBigEndian<quint16>(CHANNEL, header);
+        header[2] = TAG_APDU;
+        qToBigEndian<quint16>(index, header + 3);
+        uchar* payload = header + HEADER_SIZE;
+        int capacity = next;
+        if (index == 0) {
+            qToBigEndian<quint16>(apdu.size(), payload);
+            payload += 2;
+            capacity = first;
+        }
+        const int count = qMin(capacity, remaining);
+        std::memcpy(payload, data, count);
+        data += count;
+        remaining -= count;
+    }
+    return m_count;
+}
+
+HIDFrameReader::Result HIDFrameReader::read(const char* report, int size)
+{
+    if (size < HEADER_SIZE) return Invalid;
+    const uchar* header = reinterpret_cast<const uchar*>(report);
+    if (qFromBigEndian<quint16>(header) != CHANNEL || header[2] != TAG_APDU) return Invalid;
+    const quint16 index = qFromBigEndian<quint16>(header + 3);
+    const uchar* payload = header + HEADER_SIZE;
+    int available = size - HEADER_SIZE;
+
+    if (index == 0) {
+        if (available < 2) return Invalid;
+        m_length = qFromBigEndian<quint16>(payload);
+        m_offset = 0;
+        // Keeps the allocation of previous responses
+        m_response.resize(m_length);
+        payload += 2;
+        available -= 2;
+    } else if (index != m_index + 1 || m_offset == 0 || m_offset == m_length) {
+        return Invalid;
+    }
+    m_index = index;
+
+    const int count = qMin(available, m_length - m_offset);
+    std::memcpy(m_response.data() + m_offset, payload, count);
+    m_offset += count;
+    return m_offset < m_length ? Incomplete : Complete;
+}
+
+void HIDFrameReader::reset()
+{
+    m_length = 0;
+    m_offset = 0;
+    m_index = 0;
+}
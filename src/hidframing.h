@@ -0,0 +1,49 @@
+#ifndef GREEN_HIDFRAMING_H
+#define GREEN_HIDFRAMING_H
+
+#include <QByteArray>
+
+// Ledger HID transport framing. An APDU is split in 64 byte reports, each
+// starting with the channel, the APDU tag and a big endian sequence index,
+// the first report also carries the APDU length.
+
+// Frames APDUs into a buffer that is reused across calls, so that sending
+// an APDU doesn't allocate once the buffer fits the largest APDU. Each
+// report is preceded by the report id byte expected by hidraw and hidapi.
+class HIDFrameWriter
+{
+public:
+    static const int REPORT_SIZE = 64;
+
+    // Returns the number of reports
+    int frame(const QByteArray& apdu);
+
+    int count() const { return m_count; }
+    // Report id followed by the report
+    const char* report(int index) const { return m_buffer.constData() + index * (REPORT_SIZE + 1); }
+
+private:
+    QByteArray m_buffer;
+    int m_count{0};
+};
+
+// Reassembles an APDU response from consecutive reports into a buffer
+// that is reused across responses.
+class HIDFrameReader
+{
+public:
+    enum Result { Incomplete, Complete, Invalid };
+
+    Result read(const char* report, int size);
+    // Complete response, including the status word
+    const QByteArray& response() const { return m_response; }
+    void reset();
+
+private:
+    QByteArray m_response;
+    int m_length{0};
+    int m_offset{0};
+    quint16 m_index{0};
+};
+
+#endif // GREEN_HIDFRAMING_H
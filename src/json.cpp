@@ -15,10 +15,22 @@ void Destructor::operator()(GA_json* json)
 
 namespace {
 
+struct StringDestructor {
+    void operator()(char* string) { GA_destroy_string(string); }
+};
+
+// GDK only exposes GA_json contents as text, so parse it in place from the
+// buffer GDK allocated. QJsonDocument::fromJson builds its own storage in a
+// single pass, which means the GDK string never has to be copied into an
+// intermediate QByteArray before being released.
 QJsonDocument doc(const GA_json* json)
 {
     Q_ASSERT(json);
-    return QJsonDocument::fromJson(jsonToString(json));
+    char* str;
+    int err = GA_convert_json_to_string(json, &str);
+    Q_ASSERT(err == GA_OK);
+    std::unique_ptr<char, StringDestructor> string(str);
+    return QJsonDocument::fromJson(QByteArray::fromRawData(str, static_cast<int>(qstrlen(str))));
 }
 
 } // namespace
@@ -35,13 +47,14 @@ QJsonObject toObject(const GA_json* json)
 
 std::unique_ptr<GA_json, Destructor> fromObject(const QJsonObject& object)
 {
-    return stringToJson(QJsonDocument(object).toJson());
+    // Compact output avoids the indentation GDK would just skip over
+    return stringToJson(QJsonDocument(object).toJson(QJsonDocument::Compact));
 }
 
 std::unique_ptr<GA_json, Destructor> stringToJson(const QByteArray& string)
 {
     GA_json* json;
-    GA_convert_string_to_json(string, &json);
+    GA_convert_string_to_json(string.constData(), &json);
     return std::unique_ptr<GA_json, Destructor>(json);
 }
 
@@ -57,6 +70,3 @@ QByteArray jsonToString(const GA_json* json)
 
 
 } // namespace Json
-
-
-
@@ -17,3 +17,10 @@ HEADERS += \
     $$PWD/ledgersignliquidtransactionactivity.h \
     $$PWD/ledgersignmessageactivity.h \
     $$PWD/ledgersigntransactionactivity.h
+
+# Development builds only, run qmake with CONFIG+=virtualledger
+CONFIG(virtualledger) {
+    DEFINES += BUILD_VIRTUAL_LEDGER
+    SOURCES += $$PWD/ledgervirtualdevice.cpp
+    HEADERS += $$PWD/ledgervirtualdevice.h
+}
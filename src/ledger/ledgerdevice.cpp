@@ -17,6 +17,10 @@ LedgerDevice::LedgerDevice(DevicePrivate* d, QObject* parent)
 
 LedgerDevice::~LedgerDevice()
 {
+    // Activities release their commands to the pool when destroyed
+    qDeleteAll(findChildren<Activity*>(QString(), Qt::FindDirectChildrenOnly));
+    qDeleteAll(m_command_pool);
+    qDeleteAll(m_released_commands);
     delete d;
 }
 
@@ -45,6 +49,38 @@ DeviceCommand* LedgerDevice::exchange(const QByteArray& data) {
     return command;
 }
 
+LedgerGenericCommand* LedgerDevice::acquireCommand(const QByteArray& data)
+{
+    if (m_command_pool.isEmpty()) return new LedgerGenericCommand(this, data);
+    auto command = m_command_pool.takeLast();
+    command->setPayload(data);
+    return command;
+}
+
+void LedgerDevice::releaseCommand(LedgerGenericCommand* command)
+{
+    command->disconnect();
+    // Commands still queued on the device are recycled once dequeued
+    if (command->m_queued) {
+        m_released_commands.insert(command);
+        return;
+    }
+    command->m_reader.reset();
+    command->m_response.clear();
+    if (m_command_pool.size() < 256) {
+        m_command_pool.append(command);
+    } else {
+        delete command;
+    }
+}
+
+bool LedgerDevice::commandDequeued(DeviceCommand* command)
+{
+    if (!m_released_commands.remove(command)) return false;
+    releaseCommand(static_cast<LedgerGenericCommand*>(command));
+    return true;
+}
+
 GetWalletPublicKeyActivity *LedgerDevice::getWalletPublicKey(Network* network, const QVector<uint32_t>& path)
 {
     return new LedgerGetWalletPublicKeyActivity(network, path, this);
@@ -4,6 +4,8 @@
 #include "command.h"
 #include "device.h"
 
+#include <QSet>
+
 QT_FORWARD_DECLARE_CLASS(LedgerDevice);
 
 #define BTCHIP_CLA              0xe0
@@ -85,6 +87,13 @@ public:
 
     DeviceCommand* exchange(const QByteArray& data);
 
+    // Signing issues hundreds of commands, these are recycled once the
+    // activity that acquired them is done
+    LedgerGenericCommand* acquireCommand(const QByteArray& data);
+    void releaseCommand(LedgerGenericCommand* command);
+    // Recycles a command released while queued, returns true if it was
+    bool commandDequeued(DeviceCommand* command);
+
     GetWalletPublicKeyActivity* getWalletPublicKey(Network* network, const QVector<uint32_t>& path) override;
     SignMessageActivity* signMessage(const QString& message, const QVector<uint32_t>& path) override;
     SignTransactionActivity* signTransaction(Network* network, const QJsonObject& transaction, const QJsonArray& signing_inputs, const QJsonArray& transaction_outputs, const QJsonObject& signing_transactions, const QJsonArray& signing_address_types) override;
@@ -100,6 +109,9 @@ public:
 private:
     friend class DevicePrivate;
     DevicePrivate* const d;
+    QList<LedgerGenericCommand*> m_command_pool;
+    // Released while still queued on the device
+    QSet<DeviceCommand*> m_released_commands;
 };
 
 #endif // GREEN_LEDGERDEVICE_H
@@ -47,6 +47,11 @@ LedgerSignLiquidTransactionActivity::LedgerSignLiquidTransactionActivity(const Q
     connect(m_batch, &Command::error, this, [this] { fail(); });
 }
 
+LedgerSignLiquidTransactionActivity::~LedgerSignLiquidTransactionActivity()
+{
+    for (auto command : m_commands) m_device->releaseCommand(command);
+}
+
 void LedgerSignLiquidTransactionActivity::exec()
 {
     exchange_total = 3 + 6 * m_inputs.size() + 5 * m_outputs.size();
@@ -188,8 +193,9 @@ void LedgerSignLiquidTransactionActivity::getLiquidCommitment(int output_index)
 
 DeviceCommand *LedgerSignLiquidTransactionActivity::exchange(const QByteArray& data)
 {
-    auto command = new LedgerGenericCommand(m_device, data);
-    connect(command, &Command::finished, [this] {
+    auto command = m_device->acquireCommand(data);
+    m_commands.append(command);
+    connect(command, &Command::finished, this, [this] {
        exchange_count ++;
        progress()->setValue(exchange_count);
     });
@@ -5,11 +5,13 @@
 
 QT_FORWARD_DECLARE_CLASS(CommandBatch);
 QT_FORWARD_DECLARE_CLASS(LedgerDevice);
+QT_FORWARD_DECLARE_CLASS(LedgerGenericCommand);
 
 class LedgerSignLiquidTransactionActivity : public SignLiquidTransactionActivity
 {
 public:
     LedgerSignLiquidTransactionActivity(const QJsonObject& transaction, const QJsonArray& signing_inputs, const QJsonArray& outputs, LedgerDevice* device);
+    ~LedgerSignLiquidTransactionActivity();
 
     virtual QList<QByteArray> signatures() const override { return m_sigs; }
     virtual QList<QByteArray> assetCommitments() const override { return m_asset_commitments; }
@@ -46,6 +48,7 @@ public:
     int exchange_count{0};
     int exchange_total{0};
     CommandBatch* m_batch;
+    QList<LedgerGenericCommand*> m_commands;
 };
 
 #endif // LEDGERSIGNLIQUIDTRANSACTIONACTIVITY_H
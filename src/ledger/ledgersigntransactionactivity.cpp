@@ -16,6 +16,11 @@ LedgerSignTransactionActivity::LedgerSignTransactionActivity(const QJsonObject&
 {
 }
 
+LedgerSignTransactionActivity::~LedgerSignTransactionActivity()
+{
+    for (auto command : m_commands) m_device->releaseCommand(command);
+}
+
 QList<QByteArray> LedgerSignTransactionActivity::signatures() const
 {
     return m_signatures;
@@ -23,7 +28,8 @@ QList<QByteArray> LedgerSignTransactionActivity::signatures() const
 
 DeviceCommand *LedgerSignTransactionActivity::exchange(CommandBatch* batch, const QByteArray& data)
 {
-    auto command = new LedgerGenericCommand(m_device, data);
+    auto command = m_device->acquireCommand(data);
+    m_commands.append(command);
     batch->add(command);
     return command;
 }
@@ -4,6 +4,7 @@
 #include "command.h"
 #include "device.h"
 
+QT_FORWARD_DECLARE_CLASS(LedgerGenericCommand)
 
 struct Input {
     QByteArray value;
@@ -16,6 +17,7 @@ class LedgerSignTransactionActivity : public SignTransactionActivity
 {
 public:
     LedgerSignTransactionActivity(const QJsonObject& transaction, const QJsonArray& signing_inputs, const QJsonArray& transaction_outputs, const QJsonObject& signing_transactions, const QJsonArray& signing_address_types, LedgerDevice* device);
+    ~LedgerSignTransactionActivity();
     QList<QByteArray> signatures() const override;
     void exec() override;
     Command *startUntrustedTransaction(uint32_t version, bool new_transaction, size_t index, const QList<Input> &used_inputs, const QByteArray &redeem_script, bool segwit);
@@ -40,6 +42,7 @@ private:
 
     QList<Input> m_hw_inputs;
     QList<QByteArray> m_signatures;
+    QList<LedgerGenericCommand*> m_commands;
 };
 
 #endif // GREEN_LEDGERSIGNTRANSACTIONACTIVITY_H
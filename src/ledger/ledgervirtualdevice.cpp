@@ -0,0 +1,450 @@
+#include "command.h"
+#include "devicemanager.h"
+#include "ledgerdevice.h"
+#include "ledgervirtualdevice.h"
+#include "util.h"
+
+#include <QDebug>
+#include <QTimer>
+
+#include <wally_bip32.h>
+#include <wally_core.h>
+#include <wally_crypto.h>
+#include <wally_elements.h>
+#include <wally_transaction.h>
+
+namespace {
+
+const quint16 SW_OK = 0x9000;
+const quint16 SW_WRONG_LENGTH = 0x6700;
+const quint16 SW_INCORRECT_DATA = 0x6a80;
+const quint16 SW_INCORRECT_P1_P2 = 0x6b00;
+const quint16 SW_INS_NOT_SUPPORTED = 0x6d00;
+const quint16 SW_CLA_NOT_SUPPORTED = 0x6e00;
+
+const char* const APP_VERSION = "1.6.3";
+
+bool ReadPath(QDataStream& stream, QVector<uint32_t>& path)
+{
+    uint8_t count;
+    stream >> count;
+    path.resize(count);
+    for (uint8_t i = 0; i < count; ++i) stream >> path[i];
+    return stream.status() == QDataStream::Ok && count <= 10;
+}
+
+// DER encoded ECDSA signature of the given hash, the recovery id is only
+// computed when requested
+QByteArray Sign(const unsigned char* private_key, const QByteArray& hash, int* recovery_id = nullptr)
+{
+    Q_ASSERT(hash.size() == SHA256_LEN);
+    unsigned char sig[EC_SIGNATURE_RECOVERABLE_LEN];
+    const uint32_t flags = EC_FLAG_ECDSA | (recovery_id ? EC_FLAG_RECOVERABLE : 0);
+    const size_t sig_len = recovery_id ? EC_SIGNATURE_RECOVERABLE_LEN : EC_SIGNATURE_LEN;
+    int res = wally_ec_sig_from_bytes(private_key, EC_PRIVATE_KEY_LEN, (const unsigned char*) hash.constData(), hash.size(), flags, sig, sig_len);
+    Q_ASSERT(res == WALLY_OK);
+    const unsigned char* compact = sig;
+    if (recovery_id) {
+        *recovery_id = (sig[0] - 27) & 3;
+        compact = sig + 1;
+    }
+    QByteArray der(EC_SIGNATURE_DER_MAX_LEN, 0);
+    size_t written;
+    res = wally_ec_sig_to_der(compact, EC_SIGNATURE_LEN, (unsigned char*) der.data(), der.size(), &written);
+    Q_ASSERT(res == WALLY_OK);
+    der.truncate(written);
+    return der;
+}
+
+QByteArray UncompressedPublicKey(const unsigned char* public_key)
+{
+    QByteArray result(EC_PUBLIC_KEY_UNCOMPRESSED_LEN, 0);
+    int res = wally_ec_public_key_decompress(public_key, EC_PUBLIC_KEY_LEN, (unsigned char*) result.data(), result.size());
+    Q_ASSERT(res == WALLY_OK);
+    return result;
+}
+
+} // namespace
+
+LedgerDevice* LedgerVirtualDevicePrivate::create(const QString& app, int latency, QObject* parent)
+{
+    // The seed is public, refuse the Bitcoin mainnet app. Liquid has no test
+    // network here, its keys still use testnet versions and prefixes
+    if (app != "Bitcoin Test" && app != "Liquid") {
+        qWarning() << "virtual ledger refuses app" << app;
+        return nullptr;
+    }
+    auto device = new LedgerDevice(new LedgerVirtualDevicePrivate(app, latency), parent);
+    DeviceManager::instance()->addDevice(device);
+    return device;
+}
+
+LedgerVirtualDevicePrivate::LedgerVirtualDevicePrivate(const QString& app, int latency)
+    : m_app(app)
+    , m_latency(latency)
+{
+    m_transport = Device::USB;
+    m_type = Device::LedgerNanoS;
+    m_unique_id = 0;
+
+    const auto seed = QCryptographicHash::hash("green virtual ledger", QCryptographicHash::Sha512);
+    int res = bip32_key_from_seed_alloc((const unsigned char*) seed.constData(), seed.size(), BIP32_VER_TEST_PRIVATE, 0, &m_master);
+    Q_ASSERT(res == WALLY_OK);
+    m_master_blinding_key.resize(HMAC_SHA512_LEN);
+    res = wally_asset_blinding_key_from_seed((const unsigned char*) seed.constData(), seed.size(), (unsigned char*) m_master_blinding_key.data(), m_master_blinding_key.size());
+    Q_ASSERT(res == WALLY_OK);
+}
+
+LedgerVirtualDevicePrivate::~LedgerVirtualDevicePrivate()
+{
+    bip32_key_free(m_master);
+}
+
+void LedgerVirtualDevicePrivate::exchange(DeviceCommand* command)
+{
+    const bool send = queue.empty();
+    enqueue(command);
+    if (send) schedule();
+}
+
+void LedgerVirtualDevicePrivate::schedule()
+{
+    requestSent();
+    // Callers connect to the command after exchange returns, so the
+    // response is always delivered asynchronously
+    QTimer::singleShot(m_latency, q, [this] { respond(); });
+}
+
+void LedgerVirtualDevicePrivate::respond()
+{
+    if (queue.empty()) return;
+    reportReceived();
+    auto command = queue.head();
+    const int r = command->readHIDReport(q, process(command->payload()));
+    responseReceived();
+    if (r == 1) qWarning("command failed");
+    dequeue();
+    if (queue.empty()) {
+        queueDrained();
+    } else {
+        schedule();
+    }
+}
+
+QByteArray LedgerVirtualDevicePrivate::process(const QByteArray& apdu)
+{
+    QByteArray response;
+    quint16 sw = SW_WRONG_LENGTH;
+    if (apdu.size() >= 5 && apdu.size() == 5 + uint8_t(apdu.at(4))) {
+        const uint8_t cla = apdu.at(0);
+        const uint8_t ins = apdu.at(1);
+        const uint8_t p1 = apdu.at(2);
+        const uint8_t p2 = apdu.at(3);
+        const QByteArray data = apdu.mid(5);
+        if (cla == BTCHIP_CLA_COMMON_SDK && ins == BTCHIP_INS_GET_APP_NAME_AND_VERSION) {
+            sw = getAppNameAndVersion(response);
+        } else if (cla != BTCHIP_CLA) {
+            sw = SW_CLA_NOT_SUPPORTED;
+        } else {
+            switch (ins) {
+            case BTCHIP_INS_GET_FIRMWARE_VERSION: sw = getFirmwareVersion(response); break;
+            case BTCHIP_INS_GET_WALLET_PUBLIC_KEY: sw = getWalletPublicKey(data, response); break;
+            case BTCHIP_INS_SIGN_MESSAGE: sw = signMessage(p1, data, response); break;
+            case BTCHIP_INS_GET_TRUSTED_INPUT: sw = getTrustedInput(p1, data, response); break;
+            case BTCHIP_INS_HASH_INPUT_START: sw = hashInputStart(p1, p2, data); break;
+            case BTCHIP_INS_HASH_INPUT_FINALIZE_FULL: sw = hashInputFinalizeFull(p1, data, response); break;
+            case BTCHIP_INS_HASH_SIGN: sw = hashSign(data, response); break;
+            case BTCHIP_INS_GET_LIQUID_BLINDING_KEY: sw = getLiquidBlindingKey(data, response); break;
+            case BTCHIP_INS_GET_LIQUID_NONCE: sw = getLiquidNonce(data, response); break;
+            case BTCHIP_INS_GET_LIQUID_BLINDING_FACTOR: sw = getLiquidBlindingFactor(p1, data, response); break;
+            case BTCHIP_INS_GET_LIQUID_COMMITMENTS: sw = getLiquidCommitments(p1, data, response); break;
+            // Issuances aren't supported, nothing to report
+            case BTCHIP_INS_GET_LIQUID_ISSUANCE_INFORMATION: sw = SW_OK; break;
+            default: sw = SW_INS_NOT_SUPPORTED;
+            }
+        }
+    }
+    if (sw != SW_OK) {
+        qDebug() << "virtual ledger rejected" << apdu.left(4).toHex() << "with" << QByteArray::number(sw, 16);
+        response.clear();
+    }
+    response.append(char(sw >> 8));
+    response.append(char(sw & 0xff));
+    return response;
+}
+
+quint16 LedgerVirtualDevicePrivate::getFirmwareVersion(QByteArray& response)
+{
+    QDataStream stream(&response, QIODevice::WriteOnly);
+    // Compressed keys, SE handled screen, arch, firmware 2.0.0, loader 0.0
+    stream << uint8_t(0x03) << uint8_t(0x30) << uint8_t(2) << uint8_t(0) << uint8_t(0) << uint8_t(0) << uint8_t(0);
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::getAppNameAndVersion(QByteArray& response)
+{
+    const QByteArray name = m_app.toLocal8Bit();
+    const QByteArray version(APP_VERSION);
+    QDataStream stream(&response, QIODevice::WriteOnly);
+    stream << uint8_t(1) << uint8_t(name.size());
+    stream.writeRawData(name.constData(), name.size());
+    stream << uint8_t(version.size());
+    stream.writeRawData(version.constData(), version.size());
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::getWalletPublicKey(const QByteArray& data, QByteArray& response)
+{
+    QDataStream input(data);
+    QVector<uint32_t> path;
+    if (!ReadPath(input, path)) return SW_WRONG_LENGTH;
+    ext_key* key = derive(path);
+
+    // Testnet P2PKH address of the compressed key
+    QByteArray address(1 + HASH160_LEN, 0x6f);
+    int res = wally_hash160(key->pub_key, EC_PUBLIC_KEY_LEN, (unsigned char*) address.data() + 1, HASH160_LEN);
+    Q_ASSERT(res == WALLY_OK);
+    char* base58;
+    res = wally_base58_from_bytes((const unsigned char*) address.constData(), address.size(), BASE58_FLAG_CHECKSUM, &base58);
+    Q_ASSERT(res == WALLY_OK);
+    address = QByteArray(base58);
+    wally_free_string(base58);
+
+    const QByteArray public_key = UncompressedPublicKey(key->pub_key);
+    QDataStream stream(&response, QIODevice::WriteOnly);
+    stream << uint8_t(public_key.size());
+    stream.writeRawData(public_key.constData(), public_key.size());
+    stream << uint8_t(address.size());
+    stream.writeRawData(address.constData(), address.size());
+    stream.writeRawData((const char*) key->chain_code, sizeof(key->chain_code));
+    bip32_key_free(key);
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::signMessage(uint8_t p1, const QByteArray& data, QByteArray& response)
+{
+    if (p1 == 0x00) {
+        QDataStream stream(data);
+        uint16_t length;
+        if (!ReadPath(stream, m_message_path)) return SW_WRONG_LENGTH;
+        stream >> length;
+        m_message.resize(length);
+        if (stream.readRawData(m_message.data(), length) != length) return SW_WRONG_LENGTH;
+        // No user confirmation required
+        response.append(char(0));
+        return SW_OK;
+    }
+    if (p1 != 0x80) return SW_INCORRECT_P1_P2;
+
+    QByteArray hash(SHA256_LEN, 0);
+    size_t written;
+    int res = wally_format_bitcoin_message((const unsigned char*) m_message.constData(), m_message.size(), BITCOIN_MESSAGE_FLAG_HASH, (unsigned char*) hash.data(), hash.size(), &written);
+    if (res != WALLY_OK) return SW_INCORRECT_DATA;
+    ext_key* key = derive(m_message_path);
+    int recovery_id;
+    response = Sign(key->priv_key + 1, hash, &recovery_id);
+    bip32_key_free(key);
+    // The first byte carries the parity of the recovery id
+    response[0] = char(0x30 | (recovery_id & 1));
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::getTrustedInput(uint8_t p1, const QByteArray& data, QByteArray& response)
+{
+    if (p1 == 0x00) {
+        if (data.size() < 4) return SW_WRONG_LENGTH;
+        QDataStream stream(data);
+        stream >> m_trusted_input_index;
+        m_trusted_input_tx = data.mid(4);
+    } else if (p1 == 0x80) {
+        m_trusted_input_tx.append(data);
+    } else {
+        return SW_INCORRECT_P1_P2;
+    }
+
+    // The previous transaction is streamed in its serialized form, it's
+    // complete once it parses
+    wally_tx* tx;
+    if (wally_tx_from_bytes((const unsigned char*) m_trusted_input_tx.constData(), m_trusted_input_tx.size(), 0, &tx) != WALLY_OK) {
+        return SW_OK;
+    }
+    if (m_trusted_input_index >= tx->num_outputs) {
+        wally_tx_free(tx);
+        return SW_INCORRECT_DATA;
+    }
+    unsigned char txid[WALLY_TXHASH_LEN];
+    int res = wally_tx_get_txid(tx, txid, sizeof(txid));
+    Q_ASSERT(res == WALLY_OK);
+
+    // Magic, nonce, outpoint and amount followed by a truncated HMAC
+    QDataStream stream(&response, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    stream << uint8_t(0x32) << uint8_t(0x00) << uint16_t(0);
+    stream.writeRawData((const char*) txid, sizeof(txid));
+    stream << m_trusted_input_index << quint64(tx->outputs[m_trusted_input_index].satoshi);
+    wally_tx_free(tx);
+    unsigned char hmac[HMAC_SHA256_LEN];
+    res = wally_hmac_sha256((const unsigned char*) m_master_blinding_key.constData(), m_master_blinding_key.size(), (const unsigned char*) response.constData(), response.size(), hmac, sizeof(hmac));
+    Q_ASSERT(res == WALLY_OK);
+    stream.writeRawData((const char*) hmac, 8);
+    m_trusted_input_tx.clear();
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::hashInputStart(uint8_t p1, uint8_t p2, const QByteArray& data)
+{
+    if (p1 == 0x00) {
+        // A new transaction resets the outputs, continuing one only
+        // replaces the inputs to sign the next one
+        m_inputs_hash.reset();
+        if (p2 != 0x80) m_outputs_hash.reset();
+    } else if (p1 != 0x80) {
+        return SW_INCORRECT_P1_P2;
+    }
+    m_inputs_hash.addData(data);
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::hashInputFinalizeFull(uint8_t p1, const QByteArray& data, QByteArray& response)
+{
+    if (p1 != 0x00 && p1 != 0x80 && p1 != 0xff) return SW_INCORRECT_P1_P2;
+    m_outputs_hash.addData(data);
+    // No user validation required
+    if (p1 == 0x80) response = QByteArray(2, 0);
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::hashSign(const QByteArray& data, QByteArray& response)
+{
+    QDataStream stream(data);
+    QVector<uint32_t> path;
+    if (!ReadPath(stream, path)) return SW_WRONG_LENGTH;
+    uint8_t pin_length;
+    stream >> pin_length;
+    stream.skipRawData(pin_length);
+    uint32_t locktime;
+    uint8_t sighash;
+    stream >> locktime >> sighash;
+    if (stream.status() != QDataStream::Ok) return SW_WRONG_LENGTH;
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(m_inputs_hash.result());
+    hash.addData(m_outputs_hash.result());
+    hash.addData(data);
+
+    ext_key* key = derive(path);
+    response = Sign(key->priv_key + 1, hash.result());
+    bip32_key_free(key);
+    response.append(char(sighash));
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::getLiquidBlindingKey(const QByteArray& data, QByteArray& response)
+{
+    const QByteArray private_key = blindingPrivateKey(data);
+    unsigned char public_key[EC_PUBLIC_KEY_LEN];
+    int res = wally_ec_public_key_from_private_key((const unsigned char*) private_key.constData(), private_key.size(), public_key, sizeof(public_key));
+    Q_ASSERT(res == WALLY_OK);
+    response = UncompressedPublicKey(public_key);
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::getLiquidNonce(const QByteArray& data, QByteArray& response)
+{
+    if (data.size() < EC_PUBLIC_KEY_UNCOMPRESSED_LEN || data.at(0) != 0x04) return SW_INCORRECT_DATA;
+    const QByteArray public_key = compressPublicKey(data.left(EC_PUBLIC_KEY_UNCOMPRESSED_LEN));
+    const QByteArray private_key = blindingPrivateKey(data.mid(EC_PUBLIC_KEY_UNCOMPRESSED_LEN));
+    unsigned char shared_secret[SHA256_LEN];
+    int res = wally_ecdh((const unsigned char*) public_key.constData(), public_key.size(), (const unsigned char*) private_key.constData(), private_key.size(), shared_secret, sizeof(shared_secret));
+    if (res != WALLY_OK) return SW_INCORRECT_DATA;
+    response.resize(SHA256_LEN);
+    res = wally_sha256(shared_secret, sizeof(shared_secret), (unsigned char*) response.data(), response.size());
+    Q_ASSERT(res == WALLY_OK);
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::getLiquidBlindingFactor(uint8_t p1, const QByteArray& data, QByteArray& response)
+{
+    if (p1 != 0x01 && p1 != 0x02) return SW_INCORRECT_P1_P2;
+    if (data.size() != 4) return SW_WRONG_LENGTH;
+    QDataStream stream(data);
+    uint32_t output_index;
+    stream >> output_index;
+    response = blindingFactor(p1 == 0x01 ? 'a' : 'v', output_index);
+    return SW_OK;
+}
+
+quint16 LedgerVirtualDevicePrivate::getLiquidCommitments(uint8_t p1, const QByteArray& data, QByteArray& response)
+{
+    if (p1 != 0x01 && p1 != 0x02) return SW_INCORRECT_P1_P2;
+    if (data.size() != (p1 == 0x01 ? 44 : 44 + BLINDING_FACTOR_LEN)) return SW_WRONG_LENGTH;
+
+    QDataStream stream(data);
+    QByteArray asset_id(ASSET_TAG_LEN, 0);
+    quint64 value;
+    uint32_t output_index;
+    stream.readRawData(asset_id.data(), asset_id.size());
+    stream >> value >> output_index;
+    const QByteArray abf = blindingFactor('a', output_index);
+    QByteArray vbf = blindingFactor('v', output_index);
+    // The last output value blinder balances the transaction
+    if (p1 == 0x02) vbf = data.mid(44);
+
+    const QByteArray asset = ReverseByteArray(asset_id);
+    unsigned char generator[ASSET_GENERATOR_LEN];
+    int res = wally_asset_generator_from_bytes((const unsigned char*) asset.constData(), asset.size(), (const unsigned char*) abf.constData(), abf.size(), generator, sizeof(generator));
+    if (res != WALLY_OK) return SW_INCORRECT_DATA;
+    unsigned char commitment[ASSET_COMMITMENT_LEN];
+    res = wally_asset_value_commitment(value, (const unsigned char*) vbf.constData(), vbf.size(), generator, sizeof(generator), commitment, sizeof(commitment));
+    if (res != WALLY_OK) return SW_INCORRECT_DATA;
+
+    // Laid out where LedgerSignLiquidTransactionActivity reads it, the
+    // blinders followed by the asset and value commitments at offset 69
+    response = abf + vbf + QByteArray(5, 0);
+    response.append((const char*) generator, sizeof(generator));
+    response.append((const char*) commitment, sizeof(commitment));
+    return SW_OK;
+}
+
+ext_key* LedgerVirtualDevicePrivate::derive(const QVector<uint32_t>& path) const
+{
+    ext_key* key;
+    if (path.isEmpty()) {
+        // Deriving requires a non empty path, copy the master key instead
+        unsigned char serialized[BIP32_SERIALIZED_LEN];
+        int res = bip32_key_serialize(m_master, BIP32_FLAG_KEY_PRIVATE, serialized, sizeof(serialized));
+        Q_ASSERT(res == WALLY_OK);
+        res = bip32_key_unserialize_alloc(serialized, sizeof(serialized), &key);
+        Q_ASSERT(res == WALLY_OK);
+        return key;
+    }
+    int res = bip32_key_from_parent_path_alloc(m_master, path.constData(), path.size(), BIP32_FLAG_KEY_PRIVATE, &key);
+    Q_ASSERT(res == WALLY_OK);
+    return key;
+}
+
+QByteArray LedgerVirtualDevicePrivate::blindingPrivateKey(const QByteArray& script) const
+{
+    QByteArray private_key(EC_PRIVATE_KEY_LEN, 0);
+    int res = wally_asset_blinding_key_to_ec_private_key(
+                (const unsigned char*) m_master_blinding_key.constData(), m_master_blinding_key.size(),
+                (const unsigned char*) script.constData(), script.size(),
+                (unsigned char*) private_key.data(), private_key.size());
+    Q_ASSERT(res == WALLY_OK);
+    return private_key;
+}
+
+QByteArray LedgerVirtualDevicePrivate::blindingFactor(char tag, uint32_t output_index) const
+{
+    // Bound to the inputs of the transaction being signed
+    QByteArray data = m_inputs_hash.result();
+    QDataStream stream(&data, QIODevice::WriteOnly | QIODevice::Append);
+    stream << uint8_t(tag) << output_index;
+    QByteArray result(HMAC_SHA256_LEN, 0);
+    int res = wally_hmac_sha256(
+                (const unsigned char*) m_master_blinding_key.constData(), m_master_blinding_key.size(),
+                (const unsigned char*) data.constData(), data.size(),
+                (unsigned char*) result.data(), result.size());
+    Q_ASSERT(res == WALLY_OK);
+    return result;
+}
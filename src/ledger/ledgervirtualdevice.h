@@ -0,0 +1,65 @@
+#ifndef GREEN_LEDGERVIRTUALDEVICE_H
+#define GREEN_LEDGERVIRTUALDEVICE_H
+
+#include "device_p.h"
+
+#include <QCryptographicHash>
+
+struct ext_key;
+
+// In process Ledger transport answering the BTCHIP APDUs used by the Ledger
+// activities with deterministic test keys, so that signing and resolvers can
+// be exercised and timed without hardware. Each APDU is answered after the
+// configured latency. Signatures are made with the test keys but over a
+// digest of the streamed transaction instead of the consensus signature
+// hash, so transactions signed with it don't validate. Only built with
+// CONFIG+=virtualledger.
+class LedgerVirtualDevicePrivate : public DevicePrivate
+{
+public:
+    // Creates a device running the given app, "Bitcoin Test" or "Liquid",
+    // and adds it to DeviceManager, returns nullptr for other apps
+    static LedgerDevice* create(const QString& app, int latency, QObject* parent = nullptr);
+
+    LedgerVirtualDevicePrivate(const QString& app, int latency);
+    ~LedgerVirtualDevicePrivate() override;
+    void exchange(DeviceCommand* command) override;
+
+private:
+    void schedule();
+    void respond();
+    QByteArray process(const QByteArray& apdu);
+
+    // Handlers return the status word and fill the response data
+    quint16 getFirmwareVersion(QByteArray& response);
+    quint16 getAppNameAndVersion(QByteArray& response);
+    quint16 getWalletPublicKey(const QByteArray& data, QByteArray& response);
+    quint16 signMessage(uint8_t p1, const QByteArray& data, QByteArray& response);
+    quint16 getTrustedInput(uint8_t p1, const QByteArray& data, QByteArray& response);
+    quint16 hashInputStart(uint8_t p1, uint8_t p2, const QByteArray& data);
+    quint16 hashInputFinalizeFull(uint8_t p1, const QByteArray& data, QByteArray& response);
+    quint16 hashSign(const QByteArray& data, QByteArray& response);
+    quint16 getLiquidBlindingKey(const QByteArray& data, QByteArray& response);
+    quint16 getLiquidNonce(const QByteArray& data, QByteArray& response);
+    quint16 getLiquidBlindingFactor(uint8_t p1, const QByteArray& data, QByteArray& response);
+    quint16 getLiquidCommitments(uint8_t p1, const QByteArray& data, QByteArray& response);
+
+    ext_key* derive(const QVector<uint32_t>& path) const;
+    QByteArray blindingPrivateKey(const QByteArray& script) const;
+    QByteArray blindingFactor(char tag, uint32_t output_index) const;
+
+    const QString m_app;
+    const int m_latency;
+    ext_key* m_master{nullptr};
+    QByteArray m_master_blinding_key;
+
+    QVector<uint32_t> m_message_path;
+    QByteArray m_message;
+    uint32_t m_trusted_input_index{0};
+    QByteArray m_trusted_input_tx;
+    // Digests of the inputs and outputs streamed for signing
+    QCryptographicHash m_inputs_hash{QCryptographicHash::Sha256};
+    QCryptographicHash m_outputs_hash{QCryptographicHash::Sha256};
+};
+
+#endif // GREEN_LEDGERVIRTUALDEVICE_H
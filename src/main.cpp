@@ -8,8 +8,12 @@
 #include <QStyleHints>
 #include <QTranslator>
 
+#include "asseticonprovider.h"
 #include "clipboard.h"
 #include "devicemanager.h"
+#ifdef BUILD_VIRTUAL_LEDGER
+#include "ledgervirtualdevice.h"
+#endif
 #include "networkmanager.h"
 #include "settings.h"
 #include "walletmanager.h"
@@ -63,6 +67,10 @@ int main(int argc, char *argv[])
     parser.addHelpOption();
     parser.addVersionOption();
     parser.addOption(QCommandLineOption("printtoconsole"));
+#ifdef BUILD_VIRTUAL_LEDGER
+    parser.addOption(QCommandLineOption("virtualledger", "Adds a virtual Ledger device running <app>, \"Bitcoin Test\" or \"Liquid\".", "app"));
+    parser.addOption(QCommandLineOption("virtualledgerlatency", "Delays each virtual Ledger APDU response by <ms> milliseconds.", "ms", "0"));
+#endif
     parser.process(app);
 
     if (parser.isSet("printtoconsole")) {
@@ -123,8 +131,15 @@ int main(int argc, char *argv[])
     qmlRegisterSingletonInstance<Settings>("Blockstream.Green.Core", 0, 1, "Settings", Settings::instance());
     qmlRegisterSingletonInstance<WalletManager>("Blockstream.Green.Core", 0, 1, "WalletManager", WalletManager::instance());
 
+#ifdef BUILD_VIRTUAL_LEDGER
+    if (parser.isSet("virtualledger")) {
+        LedgerVirtualDevicePrivate::create(parser.value("virtualledger"), parser.value("virtualledgerlatency").toInt(), &app);
+    }
+#endif
+
     QQmlApplicationEngine engine;
     engine.setBaseUrl(QUrl("qrc:/"));
+    engine.addImageProvider("asset", new AssetIconProvider);
 
     QZXing::registerQMLTypes();
     QZXing::registerQMLImageProvider(engine);
@@ -1,4 +1,5 @@
 #include "device.h"
+#include "devicecache.h"
 #include "handler.h"
 #include "network.h"
 #include "resolver.h"
@@ -93,14 +94,77 @@ GetXPubsResolver::GetXPubsResolver(Handler* handler, const QJsonObject& result)
 
 void GetXPubsResolver::resolve()
 {
+    if (!m_cache) {
+        // A single exchange identifies the device, the xpubs of a known
+        // device are then taken from the cache
+        auto activity = device()->getWalletPublicKey(network(), {});
+        connect(activity, &Activity::finished, this, [this, activity] {
+            activity->deleteLater();
+            const auto master_xpub = QString::fromLocal8Bit(activity->publicKey());
+            m_cache = DeviceCache::get(network()->id(), master_xpub);
+            if (!m_cache) return setFailed(true);
+            device()->setCache(m_cache);
+            m_cache->setXPub({}, master_xpub);
+            resolve();
+        });
+        connect(activity, &GetWalletPublicKeyActivity::failed, this, [this, activity] {
+            activity->deleteLater();
+            setFailed(true);
+        });
+        activity->exec();
+        return;
+    }
+
+    if (!m_cache->isVerified()) {
+        // Check one cached xpub against the device before trusting the
+        // others, the master xpub already comes from the device
+        for (const auto& path : m_paths) {
+            if (!path.isEmpty() && !m_cache->xpub(path).isEmpty()) return verify(path);
+        }
+    }
+
+    while (!m_paths.empty()) {
+        const auto xpub = m_cache->xpub(m_paths.first());
+        if (xpub.isEmpty()) break;
+        m_xpubs.append(xpub);
+        m_paths.removeFirst();
+    }
+
     emit progress(m_xpubs.size(), m_xpubs.size() + m_paths.size());
-    if (m_paths.empty()) return emit m_handler->resolve({{ "xpubs", m_xpubs }});
+    if (m_paths.empty()) {
+        m_cache->save();
+        return emit m_handler->resolve({{ "xpubs", m_xpubs }});
+    }
 
     auto path = m_paths.takeFirst();
     auto activity = device()->getWalletPublicKey(network(), path);
-    connect(activity, &Activity::finished, this, [this, activity] {
+    connect(activity, &Activity::finished, this, [this, activity, path] {
+        activity->deleteLater();
+        const auto xpub = QString::fromLocal8Bit(activity->publicKey());
+        m_cache->setXPub(path, xpub);
+        m_xpubs.append(xpub);
+        resolve();
+    });
+    connect(activity, &GetWalletPublicKeyActivity::failed, this, [this, activity] {
+        activity->deleteLater();
+        setFailed(true);
+    });
+    activity->exec();
+}
+
+void GetXPubsResolver::verify(const QVector<uint32_t>& path)
+{
+    auto activity = device()->getWalletPublicKey(network(), path);
+    connect(activity, &Activity::finished, this, [this, activity, path] {
         activity->deleteLater();
-        m_xpubs.append(QString::fromLocal8Bit(activity->publicKey()));
+        const auto xpub = QString::fromLocal8Bit(activity->publicKey());
+        if (xpub != m_cache->xpub(path)) {
+            qWarning() << "discard device cache, xpub doesn't match the device";
+            m_cache->clear();
+            m_cache->setXPub({}, m_cache->masterXPub());
+            m_cache->setXPub(path, xpub);
+        }
+        m_cache->setVerified();
         resolve();
     });
     connect(activity, &GetWalletPublicKeyActivity::failed, this, [this, activity] {
@@ -160,21 +224,47 @@ void BlindingKeysResolver::resolve()
 {
     Q_ASSERT(m_keys.size() == m_scripts.size());
 
-    if (m_scripts.empty()) return m_handler->resolve({{ "blinding_keys", m_blinding_keys }});
+    // Blinding keys only depend on the script, the ones not cached are
+    // requested all at once and queued on the device. Activities of a
+    // previous resolve are ignored once they finish
+    ++m_request;
+    m_cache = device()->cache();
+    m_blinding_keys = {};
+    m_pending = 0;
+    m_error = false;
+    for (int i = 0; i < m_scripts.size(); ++i) {
+        const auto key = m_keys.at(i);
+        const auto script = m_scripts.at(i);
+        const auto blinding_key = m_cache ? m_cache->blindingKey(script) : QByteArray();
+        if (!blinding_key.isEmpty()) {
+            m_blinding_keys.insert(key, QString::fromLocal8Bit(blinding_key.toHex()));
+            continue;
+        }
+        auto activity = device()->getBlindingKey(script);
+        connect(activity, &Activity::finished, this, [this, request = m_request, activity, key, script] {
+            activity->deleteLater();
+            if (request != m_request || m_error) return;
+            const auto blinding_key = activity->publicKey();
+            if (m_cache) m_cache->setBlindingKey(script, blinding_key);
+            m_blinding_keys.insert(key, QString::fromLocal8Bit(blinding_key.toHex()));
+            if (--m_pending == 0) finish();
+        });
+        connect(activity, &Activity::failed, this, [this, request = m_request, activity] {
+            activity->deleteLater();
+            if (request != m_request || m_error) return;
+            m_error = true;
+            m_handler->error();
+        });
+        m_pending++;
+        activity->exec();
+    }
+    if (m_pending == 0) finish();
+}
 
-    const auto key = m_keys.takeFirst();
-    const auto script = m_scripts.takeFirst();
-    auto activity = device()->getBlindingKey(script);
-    connect(activity, &Activity::finished, this, [this, activity, key] {
-        activity->deleteLater();
-        m_blinding_keys.insert(key, QString::fromLocal8Bit(activity->publicKey().toHex()));
-        resolve();
-    });
-    connect(activity, &Activity::failed, this, [this, activity] {
-        activity->deleteLater();
-        m_handler->error();
-    });
-    activity->exec();
+void BlindingKeysResolver::finish()
+{
+    if (m_cache) m_cache->save();
+    m_handler->resolve({{ "blinding_keys", m_blinding_keys }});
 }
 
 BlindingKeyResolver::BlindingKeyResolver(Handler* handler, const QJsonObject& result)
@@ -186,9 +276,19 @@ BlindingKeyResolver::BlindingKeyResolver(Handler* handler, const QJsonObject& re
 
 void BlindingKeyResolver::resolve()
 {
+    DeviceCache* cache = device()->cache();
+    const auto cached = cache ? cache->blindingKey(m_script) : QByteArray();
+    if (!cached.isEmpty()) {
+        return m_handler->resolve({{ "blinding_key", QString::fromLocal8Bit(cached.toHex()) }});
+    }
+
     auto activity = device()->getBlindingKey(m_script);
-    connect(activity, &Activity::finished, [this, activity] {
+    connect(activity, &Activity::finished, [this, activity, cache] {
         activity->deleteLater();
+        if (cache) {
+            cache->setBlindingKey(m_script, activity->publicKey());
+            cache->save();
+        }
         const auto blinding_key = QString::fromLocal8Bit(activity->publicKey().toHex());
         m_handler->resolve({{ "blinding_key", blinding_key }});
     });
@@ -204,8 +304,8 @@ BlindingNoncesResolver::BlindingNoncesResolver(Handler* handler, const QJsonObje
     : DeviceResolver(handler, result)
 {
     for (const auto blinded_script : m_required_data.value("blinded_scripts").toArray()) {
-        m_pubkeys.append(blinded_script.toObject().value("pubkey").toString());
-        m_scripts.append(blinded_script.toObject().value("script").toString());
+        m_pubkeys.append(QByteArray::fromHex(blinded_script.toObject().value("pubkey").toString().toLocal8Bit()));
+        m_scripts.append(QByteArray::fromHex(blinded_script.toObject().value("script").toString().toLocal8Bit()));
     }
 }
 
@@ -213,22 +313,62 @@ void BlindingNoncesResolver::resolve()
 {
     Q_ASSERT(m_pubkeys.size() == m_scripts.size());
 
-    if (m_pubkeys.empty()) return m_handler->resolve({{ "nonces", m_nonces }});
+    // Nonces are deterministic, only the ones not cached go to the device.
+    // Activities of a previous resolve are ignored once they finish
+    ++m_request;
+    m_cache = device()->cache();
+    m_nonces.clear();
+    m_pending = 0;
+    m_resolved = 0;
+    m_error = false;
+    for (int i = 0; i < m_pubkeys.size(); ++i) {
+        const auto nonce = m_cache ? m_cache->nonce(m_pubkeys.at(i), m_scripts.at(i)) : QByteArray();
+        m_nonces.append(QString::fromLocal8Bit(nonce.toHex()));
+        if (!nonce.isEmpty()) m_resolved++;
+    }
+    m_next = 0;
+    dispatch();
+}
 
-    const auto pubkey = QByteArray::fromHex(m_pubkeys.takeFirst().toLocal8Bit());
-    const auto script = QByteArray::fromHex(m_scripts.takeFirst().toLocal8Bit());
+void BlindingNoncesResolver::dispatch()
+{
+    // Keep a few requests queued on the device so that the next one is
+    // sent as soon as the previous response arrives
+    const int max_pending = 4;
+    emit progress(m_resolved, m_nonces.size());
+    if (m_resolved == m_nonces.size()) return finish();
+
+    for (; m_next < m_nonces.size() && m_pending < max_pending; ++m_next) {
+        if (!m_nonces.at(m_next).isEmpty()) continue;
+        const int index = m_next;
+        const auto pubkey = m_pubkeys.at(index);
+        const auto script = m_scripts.at(index);
+        auto activity = device()->getBlindingNonce(pubkey, script);
+        connect(activity, &Activity::finished, this, [this, request = m_request, activity, index, pubkey, script] {
+            activity->deleteLater();
+            if (request != m_request || m_error) return;
+            const auto nonce = activity->nonce();
+            if (m_cache) m_cache->setNonce(pubkey, script, nonce);
+            m_nonces[index] = QString::fromLocal8Bit(nonce.toHex());
+            m_pending--;
+            m_resolved++;
+            dispatch();
+        });
+        connect(activity, &Activity::failed, this, [this, request = m_request, activity] {
+            activity->deleteLater();
+            if (request != m_request || m_error) return;
+            m_error = true;
+            m_handler->error();
+        });
+        m_pending++;
+        activity->exec();
+    }
+}
 
-    auto activity = device()->getBlindingNonce(pubkey, script);
-    connect(activity, &Activity::finished, this, [this, activity] {
-        activity->deleteLater();
-        m_nonces.append(QString::fromLocal8Bit(activity->nonce().toHex()));
-        resolve();
-    });
-    connect(activity, &Activity::failed, this, [this, activity] {
-        activity->deleteLater();
-        m_handler->error();
-    });
-    activity->exec();
+void BlindingNoncesResolver::finish()
+{
+    if (m_cache) m_cache->save();
+    m_handler->resolve({{ "nonces", QJsonArray::fromStringList(m_nonces) }});
 }
 
 SignLiquidTransactionResolver::SignLiquidTransactionResolver(Handler* handler, const QJsonObject& result)
@@ -7,6 +7,7 @@
 
 QT_FORWARD_DECLARE_CLASS(Activity)
 QT_FORWARD_DECLARE_CLASS(Device)
+QT_FORWARD_DECLARE_CLASS(DeviceCache)
 QT_FORWARD_DECLARE_CLASS(Handler)
 QT_FORWARD_DECLARE_CLASS(Network)
 QT_FORWARD_DECLARE_CLASS(Wallet)
@@ -85,7 +86,10 @@ class GetXPubsResolver : public DeviceResolver
 public:
     GetXPubsResolver(Handler* handler, const QJsonObject& result);
     void resolve() override;
+private:
+    void verify(const QVector<uint32_t>& path);
 protected:
+    DeviceCache* m_cache{nullptr};
     QList<QVector<uint32_t>> m_paths;
     QJsonArray m_xpubs;
 };
@@ -109,9 +113,14 @@ public:
     BlindingKeysResolver(Handler* handler, const QJsonObject& result);
     void resolve() override;
 protected:
+    void finish();
     QStringList m_keys;
     QStringList m_scripts;
     QJsonObject m_blinding_keys;
+    DeviceCache* m_cache{nullptr};
+    int m_pending{0};
+    bool m_error{false};
+    int m_request{0};
 };
 
 class BlindingKeyResolver : public DeviceResolver
@@ -133,9 +142,17 @@ public:
     BlindingNoncesResolver(Handler* handler, const QJsonObject& result);
     void resolve() override;
 protected:
-    QStringList m_pubkeys;
-    QStringList m_scripts;
-    QJsonArray m_nonces;
+    void dispatch();
+    void finish();
+    QList<QByteArray> m_pubkeys;
+    QList<QByteArray> m_scripts;
+    QStringList m_nonces;
+    DeviceCache* m_cache{nullptr};
+    int m_next{0};
+    int m_pending{0};
+    int m_resolved{0};
+    bool m_error{false};
+    int m_request{0};
 };
 
 class SignLiquidTransactionResolver : public DeviceResolver
@@ -20,20 +20,27 @@ Session::Session(QObject* parent)
     }, this);
     Q_ASSERT(rc == GA_OK);
 
-    m_thread = new QThread(this);
-    m_context = new QObject;
+    for (auto lane : { Lane::Interactive, Lane::Background, Lane::Bulk }) {
+        auto thread = new QThread(this);
+        thread->setObjectName(QString("session-%1").arg(int(lane)));
+        auto context = new QObject;
+        context->moveToThread(thread);
+        thread->start();
+        m_threads.append(thread);
+        m_contexts.append(context);
+    }
 
-    m_context->moveToThread(m_thread);
-    m_thread->start();
+    m_thread = m_threads.at(int(Lane::Interactive));
+    m_context = m_contexts.at(int(Lane::Interactive));
 }
 
 Session::~Session()
 {
     GA_set_notification_handler(m_session, nullptr, nullptr);
 
-    m_context->deleteLater();
-    m_thread->quit();
-    m_thread->wait();
+    for (auto context : m_contexts) context->deleteLater();
+    for (auto thread : m_threads) thread->quit();
+    for (auto thread : m_threads) thread->wait();
 
     int rc = GA_disconnect(m_session);
     Q_ASSERT(rc == GA_OK);
@@ -42,8 +49,16 @@ Session::~Session()
     Q_ASSERT(rc == GA_OK);
 }
 
+QObject* Session::context(Lane lane) const
+{
+    return m_contexts.at(int(lane));
+}
+
 void Session::handleNotification(const QJsonObject& notification)
 {
+    // Bump before emitting so that reloads triggered by this notification
+    // don't join calls started earlier
+    ++m_generation;
     emit notificationHandled(notification);
 
     const auto event = notification.value("event").toString();
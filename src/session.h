@@ -11,15 +11,41 @@ class Session : public QObject
     Q_OBJECT
     QML_UNCREATABLE("...")
 public:
+    // GDK calls are dispatched to one of these lanes, each with its own
+    // thread, so that long calls don't block short ones behind them.
+    // Calls on the same lane run in order, calls on different lanes can
+    // complete in any order. A read on one lane can therefore return data
+    // older than a write completed on another, so writes to data that the
+    // Background lane refreshes, like memos, run on the Background lane.
+    enum class Lane {
+        // User initiated calls: login, send, 2FA, receive address
+        Interactive,
+        // Periodic refreshes: balances, subaccounts, history, assets, and
+        // the writes they must observe
+        Background,
+        // Long running jobs like transaction export
+        Bulk
+    };
+    Q_ENUM(Lane)
+    static const int LANE_COUNT = 3;
+
     Session(QObject* parent = nullptr);
     virtual ~Session();
+    QObject* context(Lane lane) const;
+    // Incremented on every notification, results of calls started before
+    // the current generation may be stale
+    int generation() const { return m_generation; }
 signals:
     void notificationHandled(const QJsonObject& notification);
     void networkEvent(bool connected, bool heartbeat_timeout, bool login_required);
     void sessionEvent(bool connected);
 private:
     void handleNotification(const QJsonObject& notification);
+    QList<QThread*> m_threads;
+    QList<QObject*> m_contexts;
+    int m_generation{0};
 public:
+    // Interactive lane
     QThread* m_thread{nullptr};
     QObject* m_context{nullptr};
     // TODO: make m_session private
@@ -85,6 +85,13 @@ void Settings::setUseTor(bool use_tor)
     emit useTorChanged(m_use_tor);
 }
 
+void Settings::setCacheTransactions(bool cache_transactions)
+{
+    if (m_cache_transactions == cache_transactions) return;
+    m_cache_transactions = cache_transactions;
+    emit cacheTransactionsChanged(m_cache_transactions);
+}
+
 void Settings::setProxyHost(const QString &proxy_host)
 {
     if (m_proxy_host == proxy_host) return;
@@ -122,6 +129,7 @@ void Settings::load()
     LOAD(m_proxy_host)
     LOAD(m_proxy_port)
     LOAD(m_use_tor)
+    LOAD(m_cache_transactions)
 #undef LOAD
 }
 
@@ -140,5 +148,6 @@ void Settings::save()
     SAVE(m_proxy_host)
     SAVE(m_proxy_port)
     SAVE(m_use_tor)
+    SAVE(m_cache_transactions)
 #undef SAVE
 }
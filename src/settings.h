@@ -18,6 +18,7 @@ class Settings : public QObject
     Q_PROPERTY(QString proxyHost READ proxyHost WRITE setProxyHost NOTIFY proxyHostChanged)
     Q_PROPERTY(int proxyPort READ proxyPort WRITE setProxyPort NOTIFY proxyPortChanged)
     Q_PROPERTY(bool useTor READ useTor WRITE setUseTor NOTIFY useTorChanged)
+    Q_PROPERTY(bool cacheTransactions READ cacheTransactions WRITE setCacheTransactions NOTIFY cacheTransactionsChanged)
 public:
     Settings(QObject* parent = nullptr);
     virtual ~Settings();
@@ -45,6 +46,8 @@ public:
     QString proxy() const;
     bool useTor() const { return m_use_tor; }
     void setUseTor(bool use_tor);
+    bool cacheTransactions() const { return m_cache_transactions; }
+    void setCacheTransactions(bool cache_transactions);
 signals:
     void windowXChanged(int window_x);
     void windowYChanged(int window_y);
@@ -57,6 +60,7 @@ signals:
     void proxyHostChanged(const QString& proxy_host);
     void proxyPortChanged(int proxy_port);
     void useTorChanged(bool use_tor);
+    void cacheTransactionsChanged(bool cache_transactions);
 private:
     void load();
     void save();
@@ -72,6 +76,8 @@ private:
     QString m_proxy_host{};
     int m_proxy_port{9001};
     bool m_use_tor{false};
+    // The transaction cache is not encrypted, keep it opt-in
+    bool m_cache_transactions{false};
 };
 
 #endif // GREEN_SETTINGS_H
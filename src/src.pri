@@ -3,13 +3,18 @@ INCLUDEPATH += $$PWD
 SOURCES += \
     $$PWD/accountcontroller.cpp \
     $$PWD/account.cpp \
+    $$PWD/amountconverter.cpp \
     $$PWD/asset.cpp \
+    $$PWD/asseticonprovider.cpp \
+    $$PWD/assettable.cpp \
     $$PWD/balance.cpp \
+    $$PWD/balancelistmodel.cpp \
     $$PWD/clipboard.cpp \
     $$PWD/command.cpp \
     $$PWD/controller.cpp \
     $$PWD/createaccountcontroller.cpp \
     $$PWD/device.cpp \
+    $$PWD/devicecache.cpp \
     $$PWD/devicediscoveryagent.cpp \
     $$PWD/devicediscoveryagent_linux.cpp \
     $$PWD/devicediscoveryagent_macos.cpp \
@@ -17,6 +22,7 @@ SOURCES += \
     $$PWD/devicelistmodel.cpp \
     $$PWD/devicemanager.cpp \
     $$PWD/ga.cpp \
+    $$PWD/hidframing.cpp \
     $$PWD/json.cpp \
     $$PWD/main.cpp \
     $$PWD/network.cpp \
@@ -28,7 +34,12 @@ SOURCES += \
     $$PWD/settings.cpp \
     $$PWD/signupcontroller.cpp \
     $$PWD/transaction.cpp \
+    $$PWD/transactioncache.cpp \
+    $$PWD/transactionexport.cpp \
+    $$PWD/transactionfiltermodel.cpp \
+    $$PWD/transactionindex.cpp \
     $$PWD/transactionlistmodel.cpp \
+    $$PWD/transactionstore.cpp \
     $$PWD/twofactorcontroller.cpp \
     $$PWD/util.cpp \
     $$PWD/wallet.cpp \
@@ -39,13 +50,18 @@ SOURCES += \
 HEADERS += \
     $$PWD/accountcontroller.h \
     $$PWD/account.h \
+    $$PWD/amountconverter.h \
     $$PWD/asset.h \
+    $$PWD/asseticonprovider.h \
+    $$PWD/assettable.h \
     $$PWD/balance.h \
+    $$PWD/balancelistmodel.h \
     $$PWD/clipboard.h \
     $$PWD/command.h \
     $$PWD/controller.h \
     $$PWD/createaccountcontroller.h \
     $$PWD/device.h \
+    $$PWD/devicecache.h \
     $$PWD/device_p.h \
     $$PWD/devicediscoveryagent.h \
     $$PWD/devicediscoveryagent_linux.h \
@@ -54,6 +70,7 @@ HEADERS += \
     $$PWD/devicelistmodel.h \
     $$PWD/devicemanager.h \
     $$PWD/ga.h \
+    $$PWD/hidframing.h \
     $$PWD/json.h \
     $$PWD/network.h \
     $$PWD/networkmanager.h \
@@ -64,7 +81,12 @@ HEADERS += \
     $$PWD/settings.h \
     $$PWD/signupcontroller.h \
     $$PWD/transaction.h \
+    $$PWD/transactioncache.h \
+    $$PWD/transactionexport.h \
+    $$PWD/transactionfiltermodel.h \
+    $$PWD/transactionindex.h \
     $$PWD/transactionlistmodel.h \
+    $$PWD/transactionstore.h \
     $$PWD/twofactorcontroller.h \
     $$PWD/util.h \
     $$PWD/wallet.h \
@@ -8,6 +8,9 @@
 #include "wallet.h"
 #include <gdk.h>
 
+#include <QCoreApplication>
+#include <QPointer>
+
 TransactionAmount::TransactionAmount(Transaction *transaction, qint64 amount)
     : TransactionAmount(transaction, nullptr, amount)
 {
@@ -38,9 +41,10 @@ QString TransactionAmount::formatAmount(bool include_ticker) const
     }
 }
 
-Transaction::Transaction(Account* account)
-    : QObject(account)
+Transaction::Transaction(Account* account, int row)
+    : QObject(nullptr)
     , m_account(account)
+    , m_row(row)
 {
 
 }
@@ -79,49 +83,13 @@ void Transaction::updateFromData(const QJsonObject& data)
     // Amounts are one time set
     if (m_amounts.empty()) {
         Wallet* wallet = m_account->wallet();
-        const auto satoshi = m_data.value("satoshi").toObject();
-        const int count = satoshi.keys().length();
-
-        if (wallet->network()->isLiquid()) {
-            const QString type = data.value("type").toString();
-
-            if (type == "redeposit") {
-                Q_ASSERT(satoshi.contains("btc"));
-                qint64 amount = satoshi.value("btc").toDouble();
-                m_amounts.append(new TransactionAmount(this, amount));
-            } else if (type == "incoming") {
-                for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
-                    Asset* asset = wallet->getOrCreateAsset(i.key());
-                    qint64 amount = i.value().toDouble();
-                    m_amounts.append(new TransactionAmount(this, asset, amount));
-                }
-            } else if (type == "outgoing") {
-                if (count == 1) {
-                    Q_ASSERT(satoshi.contains("btc"));
-                    auto asset = wallet->getOrCreateAsset("btc");
-                    qint64 amount = satoshi.value("btc").toDouble();
-                    m_amounts.append(new TransactionAmount(this, asset, amount));
-                } else {
-                    for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
-                        qint64 amount = i.value().toDouble();
-                        if (i.key() == "btc") {
-                            qint64 fee = data.value("fee").toDouble();
-                            Q_ASSERT(fee <= amount);
-                            amount -= fee;
-                            if (amount == 0) continue; // just fee
-                        }
-                        Asset* asset = wallet->getOrCreateAsset(i.key());
-                        m_amounts.append(new TransactionAmount(this, asset, amount));
-                    }
-                }
-            } else {
-                Q_UNREACHABLE();
-            }
-        } else {
-            qint64 amount = satoshi.value("btc").toDouble();
-            m_amounts.append(new TransactionAmount(this, amount));
+        const auto& store = m_account->transactionStore();
+        for (const auto& amount : store.amounts(m_row)) {
+            Asset* asset = amount.asset < 0 ? nullptr : wallet->getOrCreateAsset(store.assetId(amount.asset));
+            // Views expect an asset for every Liquid amount
+            if (amount.asset >= 0 && !asset) continue;
+            m_amounts.append(new TransactionAmount(this, asset, amount.value));
         }
-
         emit amountsChanged();
     }
 }
@@ -167,12 +135,20 @@ void Transaction::updateMemo(const QString &memo)
 
     Q_ASSERT(memo.length() <= 1024);
 
-    QMetaObject::invokeMethod(m_account->wallet()->m_session->m_context, [this, memo] {
-        auto txhash = m_data.value("txhash").toString().toLocal8Bit();
-        int err = GA_set_transaction_memo(m_account->wallet()->m_session->m_session, txhash.constData(), memo.toLocal8Bit().constData(), 0);
+    // The transaction is owned by QML and can be released before the memo
+    // is set, only the account and the store row are used afterwards. Runs
+    // on the history lane so that a fetch issued earlier can't complete
+    // after it and restore the old memo
+    auto session = m_account->wallet()->m_session;
+    const auto txhash = m_data.value("txhash").toString().toLocal8Bit();
+    const int row = m_row;
+    QPointer<Account> account(m_account);
+    QMetaObject::invokeMethod(session->context(Session::Lane::Background), [session, txhash, row, account, memo] {
+        int err = GA_set_transaction_memo(session->m_session, txhash.constData(), memo.toLocal8Bit().constData(), 0);
         Q_ASSERT(err == GA_OK);
 
-        m_data["memo"] = memo;
-        emit dataChanged(m_data);
+        QMetaObject::invokeMethod(qApp, [row, account, memo] {
+            if (account) account->setTransactionMemo(row, memo);
+        });
     });
 }
@@ -45,9 +45,12 @@ class Transaction : public QObject
     QML_ELEMENT
     QML_UNCREATABLE("Transaction is instanced by Wallet.")
 public:
-    explicit Transaction(Account* account);
+    explicit Transaction(Account* account, int row);
     virtual ~Transaction();
 
+    // Row in the account transaction store
+    int row() const { return m_row; }
+
     bool isUnconfirmed() const;
 
     Account* account() const;
@@ -69,6 +72,7 @@ signals:
 
 public:
     Account* const m_account;
+    int const m_row;
     QList<TransactionAmount*> m_amounts;
     QJsonObject m_data;
 };
@@ -0,0 +1,93 @@
+#include "settings.h"
+#include "transactioncache.h"
+#include "util.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSaveFile>
+#include <QtEndian>
+
+namespace {
+
+const QByteArray MAGIC = QByteArrayLiteral("GTXC");
+const quint32 FORMAT_VERSION = 1;
+
+QString CacheDir(const QString& wallet_id)
+{
+    return GetDataDir("transactions" + QDir::separator() + wallet_id);
+}
+
+} // namespace
+
+TransactionCache::TransactionCache(const QString& wallet_id, int pointer)
+{
+    if (wallet_id.isEmpty() || !Settings::instance()->cacheTransactions()) return;
+    m_path = CacheDir(wallet_id) + QDir::separator() + QString::number(pointer);
+}
+
+QJsonArray TransactionCache::load() const
+{
+    if (!isEnabled()) return {};
+    QFile file(m_path);
+    if (!file.open(QFile::ReadOnly)) return {};
+
+    QElapsedTimer timer;
+    timer.start();
+    const QByteArray data = file.readAll();
+    if (data.size() < MAGIC.size() + 4 || !data.startsWith(MAGIC)) {
+        qDebug() << "discard invalid transaction cache" << m_path;
+        return {};
+    }
+    const quint32 version = qFromBigEndian<quint32>(data.constData() + MAGIC.size());
+    if (version != FORMAT_VERSION) {
+        qDebug() << "discard transaction cache version" << version << m_path;
+        return {};
+    }
+    QCborParserError error;
+    const auto value = QCborValue::fromCbor(data.mid(MAGIC.size() + 4), &error);
+    if (error.error != QCborError::NoError || !value.isArray()) {
+        qDebug() << "discard corrupted transaction cache" << m_path << error.errorString();
+        return {};
+    }
+    const auto transactions = value.toArray().toJsonArray();
+    qDebug() << "loaded" << transactions.size() << "cached transactions in" << timer.elapsed() << "ms";
+    return transactions;
+}
+
+void TransactionCache::save(const QVector<Record>& records) const
+{
+    if (!isEnabled()) return;
+    QByteArray header = MAGIC;
+    header.resize(MAGIC.size() + 4);
+    qToBigEndian<quint32>(FORMAT_VERSION, header.data() + MAGIC.size());
+
+    QCborArray transactions;
+    for (const auto& record : records) {
+        auto transaction = QCborValue::fromCbor(record.details).toMap();
+        transaction.insert(QStringLiteral("txhash"), record.txhash);
+        transaction.insert(QStringLiteral("block_height"), record.block_height);
+        transactions.append(transaction);
+    }
+
+    QSaveFile file(m_path);
+    if (!file.open(QFile::WriteOnly)) {
+        qWarning() << "failed to open transaction cache" << m_path << file.errorString();
+        return;
+    }
+    file.write(header);
+    file.write(transactions.toCborValue().toCbor());
+    if (!file.commit()) {
+        qWarning() << "failed to write transaction cache" << m_path << file.errorString();
+    }
+}
+
+void TransactionCache::remove(const QString& wallet_id)
+{
+    if (wallet_id.isEmpty()) return;
+    QDir(CacheDir(wallet_id)).removeRecursively();
+}
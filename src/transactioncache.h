@@ -0,0 +1,41 @@
+#ifndef GREEN_TRANSACTIONCACHE_H
+#define GREEN_TRANSACTIONCACHE_H
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QString>
+#include <QVector>
+
+// On disk copy of the transaction history of a subaccount, newest first, as
+// returned by GA_get_transactions. Records are stored as CBOR after a magic
+// and a format version, a mismatch on either discards the cache.
+// Wallets without id, like hardware wallets, are not cached.
+// The cache is not encrypted, memos, addresses and amounts of software
+// wallets are readable by anyone with access to the data directory, so it
+// is only enabled with the cacheTransactions setting, off by default.
+class TransactionCache
+{
+public:
+    TransactionCache() = default;
+    TransactionCache(const QString& wallet_id, int pointer);
+
+    // A row of the transaction store, details is the raw CBOR map which is
+    // only decoded when saving
+    struct Record {
+        QByteArray details;
+        QString txhash;
+        int block_height{0};
+    };
+
+    bool isEnabled() const { return !m_path.isEmpty(); }
+
+    QJsonArray load() const;
+    void save(const QVector<Record>& records) const;
+
+    static void remove(const QString& wallet_id);
+
+private:
+    QString m_path;
+};
+
+#endif // GREEN_TRANSACTIONCACHE_H
@@ -0,0 +1,257 @@
+#include "account.h"
+#include "asset.h"
+#include "handlers/gettransactionshandler.h"
+#include "network.h"
+#include "resolver.h"
+#include "session.h"
+#include "transactionexport.h"
+#include "transactionstore.h"
+#include "wallet.h"
+
+#include <QCborValue>
+#include <QDebug>
+#include <QtEndian>
+
+namespace {
+
+QString AccountName(Account* account)
+{
+    return account->name().isEmpty() ? qtTrId("id_main_account") : account->name();
+}
+
+QJsonObject WithAccount(QJsonObject data, Account* account)
+{
+    data.insert("wallet", account->wallet()->name());
+    data.insert("account", AccountName(account));
+    return data;
+}
+
+QString QuoteCsv(QString value, const QString& separator)
+{
+    if (!value.contains(separator) && !value.contains('"') && !value.contains('\n') && !value.contains('\r')) return value;
+    return '"' + value.replace('"', "\"\"") + '"';
+}
+
+} // namespace
+
+TransactionWriter* TransactionWriter::create(const QString& format, Account* account, bool include_account)
+{
+    if (format == "csv") return new CsvTransactionWriter(account, include_account);
+    if (format == "jsonl") return new JsonLinesTransactionWriter(account, include_account);
+    if (format == "bin") return new BinaryTransactionWriter(account, include_account);
+    qWarning() << "unsupported export format" << format;
+    return nullptr;
+}
+
+bool TransactionWriter::isSupported(const QString& format)
+{
+    return format == "csv" || format == "jsonl" || format == "bin";
+}
+
+QString TransactionWriter::fileFilter(const QString& format)
+{
+    if (format == "jsonl") return "JSON Lines (*.jsonl)";
+    if (format == "bin") return "Binary (*.bin)";
+    return "CSV (*.csv)";
+}
+
+CsvTransactionWriter::CsvTransactionWriter(Account* account, bool include_account)
+    : m_account(account)
+    , m_include_account(include_account)
+{
+    auto wallet = m_account->wallet();
+    const auto settings = wallet->settings();
+    const auto pricing = settings.value("pricing").toObject();
+    const auto unit = settings.value("unit").toString();
+    if (m_include_account) {
+        m_fee_field = "fee";
+        m_fiat_field = "fiat";
+        m_fields = QStringList{"wallet", "account", "time", "description", "amount", "unit", m_fee_field, m_fiat_field, "fiat currency", "txhash", "memo"};
+    } else {
+        const auto now = QDateTime::currentDateTime();
+        m_fee_field = QString("fee (%1)").arg(wallet->network()->isLiquid() ? "L-" + unit : unit);
+        m_fiat_field = QString("fiat (%1 %2 %3)").arg(pricing.value("currency").toString()).arg(pricing.value("exchange").toString(), now.toString(Qt::ISODate));
+        m_fields = QStringList{"time", "description", "amount", "unit", m_fee_field, m_fiat_field, "txhash", "memo"};
+    }
+}
+
+QByteArray CsvTransactionWriter::header() const
+{
+    return m_fields.join(m_separator).toUtf8() + '\n';
+}
+
+QByteArray CsvTransactionWriter::write(const QJsonObject& data)
+{
+    const auto block_height = data.value("block_height").toInt();
+    if (block_height == 0) return {};
+
+    auto wallet = m_account->wallet();
+    const auto& converter = wallet->m_converter;
+    const auto unit = wallet->settings().value("unit").toString();
+    const auto type = data.value("type").toString();
+    const QString prefix = type != "incoming" ? "-" : "";
+    QByteArray result;
+    // Amounts are taken from the json instead of the account store so
+    // that memory doesn't grow with the exported history
+    for (const auto& amount : TransactionStore::parseAmounts(data, wallet->network()->isLiquid())) {
+        const auto asset = amount.first.isEmpty() ? nullptr : wallet->getOrCreateAsset(amount.first);
+        QStringList values;
+        for (auto field : m_fields) {
+            if (field == "wallet") {
+                values.append(wallet->name());
+            } else if (field == "account") {
+                values.append(AccountName(m_account));
+            } else if (field == "time") {
+                values.append(data.value("created_at").toString());
+            } else if (field == "description") {
+                values.append(type);
+            } else if (field == "amount") {
+                const auto formatted = asset ? asset->formatAmount(amount.second, false) : wallet->formatAmount(amount.second, false);
+                values.append((prefix + formatted).replace(",", "."));
+            } else if (field == "unit") {
+                if (asset && !asset->isLBTC()) {
+                    values.append(asset->data().value("ticker").toString());
+                } else if (asset && asset->isLBTC()) {
+                    values.append("L-" + unit);
+                } else {
+                    values.append(unit);
+                }
+            } else if (field == m_fee_field) {
+                if (type == "outgoing") {
+                    values.append(wallet->formatAmount(data.value("fee").toInt(), false).replace(",", "."));
+                } else {
+                    values.append("");
+                }
+            } else if (field == m_fiat_field) {
+                if ((asset && !asset->isLBTC()) || !converter.hasFiatRate()) {
+                    values.append("");
+                } else {
+                    values.append(converter.formatFiat(amount.second));
+                }
+            } else if (field == "fiat currency") {
+                values.append(converter.fiatCurrency());
+            } else if (field == "txhash") {
+                values.append(data.value("txhash").toString());
+            } else if (field == "memo") {
+                values.append(data.value("memo").toString());
+            } else {
+                Q_UNREACHABLE();
+            }
+        }
+        for (auto& value : values) value = QuoteCsv(value, m_separator);
+        result.append(values.join(m_separator).toUtf8());
+        result.append('\n');
+    }
+    return result;
+}
+
+JsonLinesTransactionWriter::JsonLinesTransactionWriter(Account* account, bool include_account)
+    : m_account(account)
+    , m_include_account(include_account)
+{
+}
+
+QByteArray JsonLinesTransactionWriter::write(const QJsonObject& data)
+{
+    const auto object = m_include_account ? WithAccount(data, m_account) : data;
+    return QJsonDocument(object).toJson(QJsonDocument::Compact) + '\n';
+}
+
+BinaryTransactionWriter::BinaryTransactionWriter(Account* account, bool include_account)
+    : m_account(account)
+    , m_include_account(include_account)
+{
+}
+
+QByteArray BinaryTransactionWriter::header() const
+{
+    QByteArray header("GTXB", 4);
+    header.resize(8);
+    qToBigEndian<quint32>(FORMAT_VERSION, header.data() + 4);
+    return header;
+}
+
+QByteArray BinaryTransactionWriter::write(const QJsonObject& data)
+{
+    const auto object = m_include_account ? WithAccount(data, m_account) : data;
+    const QByteArray cbor = QCborValue::fromJsonValue(object).toCbor();
+    QByteArray record(4, Qt::Uninitialized);
+    qToBigEndian<quint32>(cbor.size(), record.data());
+    return record + cbor;
+}
+
+TransactionExportJob::TransactionExportJob(Account* account, bool prefetch, QObject* parent)
+    : QObject(parent)
+    , m_account(account)
+    , m_prefetch(prefetch)
+{
+}
+
+qreal TransactionExportJob::rowsPerSecond() const
+{
+    const qint64 elapsed = m_finished ? m_elapsed : m_timer.isValid() ? m_timer.elapsed() : 0;
+    return elapsed > 0 ? 1000.0 * m_rows / elapsed : 0;
+}
+
+void TransactionExportJob::start()
+{
+    Q_ASSERT(!m_timer.isValid());
+    m_timer.start();
+    fetch(0);
+}
+
+void TransactionExportJob::fetchMore()
+{
+    if (m_finished || m_fetching || !m_timer.isValid()) return;
+    fetch(m_next_offset);
+}
+
+void TransactionExportJob::fetch(int offset)
+{
+    Q_ASSERT(!m_fetching);
+    m_fetching = true;
+    auto handler = new GetTransactionsHandler(m_account->pointer(), offset, m_count, m_account->wallet());
+    handler->setLane(Session::Lane::Bulk);
+    connect(handler, &Handler::done, this, [this, offset, handler] {
+        handler->deleteLater();
+        m_fetching = false;
+        if (m_finished) return;
+        const auto transactions = handler->transactions();
+        const bool last = transactions.size() < m_count;
+        m_next_offset = offset + m_count;
+        // Request the next page so that gdk works on it while this one is
+        // formatted and written
+        if (!last && m_prefetch) fetch(m_next_offset);
+        m_rows += transactions.size();
+        emit pageReady(transactions);
+        emit progressChanged();
+        if (last) finish(true);
+    });
+
+    connect(handler, &Handler::error, this, [this, handler] {
+        handler->deleteLater();
+        m_fetching = false;
+        finish(false);
+    });
+
+    connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
+        resolver->resolve();
+    });
+
+    handler->exec();
+}
+
+void TransactionExportJob::cancel()
+{
+    finish(false);
+}
+
+void TransactionExportJob::finish(bool success)
+{
+    if (m_finished) return;
+    m_finished = true;
+    m_elapsed = m_timer.elapsed();
+    qDebug() << "export of account" << m_account->pointer() << (success ? "finished" : "failed") << "with" << m_rows << "rows in" << m_elapsed << "ms," << rowsPerSecond() << "rows/s";
+    emit progressChanged();
+    emit finished(success);
+}
@@ -0,0 +1,131 @@
+#ifndef GREEN_TRANSACTIONEXPORT_H
+#define GREEN_TRANSACTIONEXPORT_H
+
+#include <QtQml>
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QObject>
+
+QT_FORWARD_DECLARE_CLASS(Account)
+
+// Formats transactions, as returned by GA_get_transactions, into records
+// of an export file
+class TransactionWriter
+{
+public:
+    virtual ~TransactionWriter() = default;
+    virtual QByteArray header() const = 0;
+    virtual QByteArray write(const QJsonObject& data) = 0;
+
+    // Supported formats are "csv", "jsonl" and "bin", which is also the file
+    // extension. With include_account the records identify their account.
+    // Returns nullptr for other formats.
+    static TransactionWriter* create(const QString& format, Account* account, bool include_account = false);
+    static bool isSupported(const QString& format);
+    static QString fileFilter(const QString& format);
+};
+
+// One line per amount, confirmed transactions only, fields are quoted as
+// in RFC 4180 when needed. With include_account
+// the wallet and account are prepended and the fee and fiat columns don't
+// mention the unit, so that accounts of different wallets can be merged.
+class CsvTransactionWriter : public TransactionWriter
+{
+public:
+    CsvTransactionWriter(Account* account, bool include_account = false);
+    QByteArray header() const override;
+    QByteArray write(const QJsonObject& data) override;
+private:
+    Account* const m_account;
+    const bool m_include_account;
+    const QString m_separator{","};
+    QString m_fee_field;
+    QString m_fiat_field;
+    QStringList m_fields;
+};
+
+// One JSON object per line with the full transaction details, all
+// transactions including unconfirmed ones. With include_account the
+// "wallet" and "account" names are added to each object.
+class JsonLinesTransactionWriter : public TransactionWriter
+{
+public:
+    JsonLinesTransactionWriter(Account* account, bool include_account = false);
+    QByteArray header() const override { return {}; }
+    QByteArray write(const QJsonObject& data) override;
+private:
+    Account* const m_account;
+    const bool m_include_account;
+};
+
+// Binary format, all integers big endian:
+//
+//   file   := magic version record*
+//   magic  := "GTXB"
+//   version:= uint32, currently 1
+//   record := length:uint32 cbor[length]
+//
+// Each record is a CBOR map holding the transaction exactly as returned by
+// GA_get_transactions, for instance "txhash", "block_height", "created_at",
+// "type", "memo", "fee", "fee_rate", "satoshi" (asset id to amount) and the
+// "inputs" and "outputs" arrays including blinders on Liquid. With
+// include_account the map also has "wallet" and "account". Readers must
+// ignore unknown keys, incompatible changes bump the version.
+class BinaryTransactionWriter : public TransactionWriter
+{
+public:
+    static const quint32 FORMAT_VERSION = 1;
+    BinaryTransactionWriter(Account* account, bool include_account = false);
+    QByteArray header() const override;
+    QByteArray write(const QJsonObject& data) override;
+private:
+    Account* const m_account;
+    const bool m_include_account;
+};
+
+// Pages through the history of an account on the bulk lane. With prefetch
+// the next page is requested as soon as the previous arrives, otherwise
+// only when fetchMore is called.
+class TransactionExportJob : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(Account* account READ account CONSTANT)
+    Q_PROPERTY(int rows READ rows NOTIFY progressChanged)
+    Q_PROPERTY(qreal rowsPerSecond READ rowsPerSecond NOTIFY progressChanged)
+    Q_PROPERTY(bool finished READ isFinished NOTIFY progressChanged)
+    QML_ELEMENT
+    QML_UNCREATABLE("TransactionExportJob is instanced by export controllers.")
+public:
+    TransactionExportJob(Account* account, bool prefetch, QObject* parent = nullptr);
+
+    Account* account() const { return m_account; }
+    int rows() const { return m_rows; }
+    qreal rowsPerSecond() const;
+    bool isFinished() const { return m_finished; }
+
+    void start();
+    void fetchMore();
+    // Stops fetching, pending pages are dropped and finished(false) is emitted
+    void cancel();
+
+signals:
+    void pageReady(const QJsonArray& transactions);
+    void progressChanged();
+    void finished(bool success);
+
+private:
+    void fetch(int offset);
+    void finish(bool success);
+
+    Account* const m_account;
+    const bool m_prefetch;
+    const int m_count{30};
+    int m_next_offset{0};
+    bool m_fetching{false};
+    bool m_finished{false};
+    int m_rows{0};
+    QElapsedTimer m_timer;
+    qint64 m_elapsed{0};
+};
+
+#endif // GREEN_TRANSACTIONEXPORT_H
@@ -0,0 +1,123 @@
+#include "account.h"
+#include "transactionfiltermodel.h"
+#include "transactionlistmodel.h"
+
+#include <QTimer>
+
+TransactionFilterModel::TransactionFilterModel(QObject* parent)
+    : QSortFilterProxyModel(parent)
+    , m_invalidate_timer(new QTimer(this))
+{
+    m_invalidate_timer->setSingleShot(true);
+    m_invalidate_timer->setInterval(0);
+    connect(m_invalidate_timer, &QTimer::timeout, this, &TransactionFilterModel::invalidateFilter);
+}
+
+void TransactionFilterModel::setModel(TransactionListModel* model)
+{
+    if (m_model == model) return;
+    if (m_model) disconnect(m_model, &TransactionListModel::accountChanged, this, &TransactionFilterModel::setAccount);
+    m_model = model;
+    setSourceModel(model);
+    if (m_model) connect(m_model, &TransactionListModel::accountChanged, this, &TransactionFilterModel::setAccount);
+    setAccount(m_model ? m_model->account() : nullptr);
+    emit modelChanged(m_model);
+}
+
+void TransactionFilterModel::setAccount(Account* account)
+{
+    if (m_account == account) return;
+    if (m_account) disconnect(m_account, &Account::transactionUpdated, this, &TransactionFilterModel::handleTransactionUpdated);
+    m_account = account;
+    if (m_account) connect(m_account, &Account::transactionUpdated, this, &TransactionFilterModel::handleTransactionUpdated);
+    update();
+}
+
+void TransactionFilterModel::setText(const QString& text)
+{
+    if (m_query.text == text) return;
+    m_query.text = text;
+    update();
+}
+
+QDateTime TransactionFilterModel::from() const
+{
+    return m_query.from > 0 ? QDateTime::fromMSecsSinceEpoch(m_query.from) : QDateTime();
+}
+
+void TransactionFilterModel::setFrom(const QDateTime& from)
+{
+    const qint64 value = from.isValid() ? from.toMSecsSinceEpoch() : 0;
+    if (m_query.from == value) return;
+    m_query.from = value;
+    update();
+}
+
+QDateTime TransactionFilterModel::to() const
+{
+    return m_query.to > 0 ? QDateTime::fromMSecsSinceEpoch(m_query.to) : QDateTime();
+}
+
+void TransactionFilterModel::setTo(const QDateTime& to)
+{
+    const qint64 value = to.isValid() ? to.toMSecsSinceEpoch() : 0;
+    if (m_query.to == value) return;
+    m_query.to = value;
+    update();
+}
+
+void TransactionFilterModel::setMinAmount(qint64 min_amount)
+{
+    if (m_query.min_amount == min_amount) return;
+    m_query.min_amount = min_amount;
+    update();
+}
+
+void TransactionFilterModel::setMaxAmount(qint64 max_amount)
+{
+    if (m_query.max_amount == max_amount) return;
+    m_query.max_amount = max_amount;
+    update();
+}
+
+void TransactionFilterModel::update()
+{
+    if (m_account && !m_query.isEmpty()) {
+        m_matches = m_account->transactionIndex().match(m_query);
+    } else {
+        m_matches.clear();
+    }
+    m_invalidate_timer->stop();
+    invalidateFilter();
+    emit filterChanged();
+}
+
+void TransactionFilterModel::handleTransactionUpdated(int row)
+{
+    if (!m_account || m_query.isEmpty() || !sourceModel()) return;
+    // Rows not listed yet are filtered when inserted
+    if (row >= sourceModel()->rowCount()) return;
+    if (row >= m_matches.size()) {
+        // Track rows added since the query so that later updates are seen
+        const int size = m_matches.size();
+        m_matches.resize(row + 1);
+        for (int i = size; i <= row; ++i) {
+            m_matches.setBit(i, m_account->transactionIndex().matches(i, m_query));
+        }
+        m_invalidate_timer->start();
+        return;
+    }
+    const bool match = m_account->transactionIndex().matches(row, m_query);
+    if (m_matches.testBit(row) == match) return;
+    m_matches.setBit(row, match);
+    m_invalidate_timer->start();
+}
+
+bool TransactionFilterModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
+{
+    Q_UNUSED(source_parent);
+    if (!m_account || m_query.isEmpty()) return true;
+    const int row = m_model->storeRow(source_row);
+    if (row < m_matches.size()) return m_matches.testBit(row);
+    return m_account->transactionIndex().matches(row, m_query);
+}
@@ -0,0 +1,66 @@
+#ifndef GREEN_TRANSACTIONFILTERMODEL_H
+#define GREEN_TRANSACTIONFILTERMODEL_H
+
+#include "transactionindex.h"
+
+#include <QtQml>
+#include <QDateTime>
+#include <QPointer>
+#include <QSortFilterProxyModel>
+
+QT_FORWARD_DECLARE_CLASS(Account)
+QT_FORWARD_DECLARE_CLASS(QTimer)
+QT_FORWARD_DECLARE_CLASS(TransactionListModel)
+
+// Filters a TransactionListModel using the account transaction index
+class TransactionFilterModel : public QSortFilterProxyModel
+{
+    Q_OBJECT
+    Q_PROPERTY(TransactionListModel* model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(QString text READ text WRITE setText NOTIFY filterChanged)
+    Q_PROPERTY(QDateTime from READ from WRITE setFrom NOTIFY filterChanged)
+    Q_PROPERTY(QDateTime to READ to WRITE setTo NOTIFY filterChanged)
+    Q_PROPERTY(qint64 minAmount READ minAmount WRITE setMinAmount NOTIFY filterChanged)
+    Q_PROPERTY(qint64 maxAmount READ maxAmount WRITE setMaxAmount NOTIFY filterChanged)
+    QML_ELEMENT
+public:
+    explicit TransactionFilterModel(QObject* parent = nullptr);
+
+    TransactionListModel* model() const { return m_model; }
+    void setModel(TransactionListModel* model);
+
+    QString text() const { return m_query.text; }
+    void setText(const QString& text);
+    QDateTime from() const;
+    void setFrom(const QDateTime& from);
+    QDateTime to() const;
+    void setTo(const QDateTime& to);
+    qint64 minAmount() const { return m_query.min_amount; }
+    void setMinAmount(qint64 min_amount);
+    qint64 maxAmount() const { return m_query.max_amount; }
+    void setMaxAmount(qint64 max_amount);
+
+signals:
+    void modelChanged(TransactionListModel* model);
+    void filterChanged();
+
+protected:
+    bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const override;
+
+private slots:
+    void update();
+    void handleTransactionUpdated(int row);
+
+private:
+    void setAccount(Account* account);
+
+    QPointer<TransactionListModel> m_model;
+    QPointer<Account> m_account;
+    TransactionIndex::Query m_query;
+    // Matching store rows, rows added later are checked individually
+    QBitArray m_matches;
+    // Coalesces the invalidations of bursts of updated rows
+    QTimer* const m_invalidate_timer;
+};
+
+#endif // GREEN_TRANSACTIONFILTERMODEL_H
@@ -0,0 +1,171 @@
+#include "transactionindex.h"
+#include "transactionstore.h"
+
+#include <QJsonArray>
+
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Transaction hashes are not in the trigram index, they are only scanned
+// for queries that can be part of a hash
+bool IsHashQuery(const QByteArray& text)
+{
+    return text.size() >= 4 && std::all_of(text.begin(), text.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+
+} // namespace
+
+TransactionIndex::TransactionIndex(const TransactionStore* store)
+    : m_store(store)
+{
+}
+
+void TransactionIndex::update(int row)
+{
+    const auto data = m_store->data(row);
+    QByteArray text = data.value("memo").toString().toLower().toUtf8();
+    for (const auto& key : { "inputs", "outputs" }) {
+        for (const auto value : data.value(key).toArray()) {
+            const auto address = value.toObject().value("address").toString();
+            if (!address.isEmpty()) text += '\n' + address.toLower().toUtf8();
+        }
+    }
+
+    if (row < m_text.size()) {
+        // Only the memo changes after a row is added
+        if (m_text.at(row) == text) return;
+        for (auto trigram : trigrams(m_text.at(row))) {
+            auto& rows = m_postings[trigram];
+            auto it = std::lower_bound(rows.begin(), rows.end(), row);
+            if (it != rows.end() && *it == row) rows.erase(it);
+            if (rows.isEmpty()) m_postings.remove(trigram);
+        }
+    } else {
+        Q_ASSERT(row == m_text.size());
+        m_text.resize(row + 1);
+        m_times.append({ m_store->createdAt(row), row });
+        for (const auto& amount : m_store->amounts(row)) {
+            m_amounts.append({ amount.value, row });
+        }
+    }
+
+    m_text[row] = text;
+    for (auto trigram : trigrams(text)) {
+        auto& rows = m_postings[trigram];
+        rows.insert(std::lower_bound(rows.begin(), rows.end(), row), row);
+    }
+}
+
+QBitArray TransactionIndex::match(const Query& query) const
+{
+    const qint64 min = std::numeric_limits<qint64>::min();
+    const qint64 max = std::numeric_limits<qint64>::max();
+    QBitArray result(m_text.size(), true);
+    if (!query.text.isEmpty()) {
+        result &= matchText(query.text.toLower().toUtf8());
+    }
+    if (query.from > 0 || query.to > 0) {
+        result &= matchRange(m_times, m_sorted_times, query.from > 0 ? query.from : min, query.to > 0 ? query.to : max);
+    }
+    if (query.min_amount >= 0 || query.max_amount >= 0) {
+        result &= matchRange(m_amounts, m_sorted_amounts, query.min_amount >= 0 ? query.min_amount : min, query.max_amount >= 0 ? query.max_amount : max);
+    }
+    return result;
+}
+
+bool TransactionIndex::matches(int row, const Query& query) const
+{
+    if (!query.text.isEmpty() && !matchesText(row, query.text.toLower().toUtf8())) return false;
+    const qint64 created_at = m_store->createdAt(row);
+    if (query.from > 0 && created_at < query.from) return false;
+    if (query.to > 0 && created_at > query.to) return false;
+    if (query.min_amount >= 0 || query.max_amount >= 0) {
+        for (const auto& amount : m_store->amounts(row)) {
+            if (query.min_amount >= 0 && amount.value < query.min_amount) continue;
+            if (query.max_amount >= 0 && amount.value > query.max_amount) continue;
+            return true;
+        }
+        return false;
+    }
+    return true;
+}
+
+QBitArray TransactionIndex::matchText(const QByteArray& text) const
+{
+    QBitArray result(m_text.size());
+    if (text.size() < 3) {
+        for (int row = 0; row < m_text.size(); ++row) {
+            if (matchesText(row, text)) result.setBit(row);
+        }
+        return result;
+    }
+
+    // Intersect the posting lists starting from the shortest one
+    QVector<const QVector<int>*> lists;
+    for (auto trigram : trigrams(text)) {
+        auto it = m_postings.constFind(trigram);
+        if (it == m_postings.constEnd()) {
+            lists.clear();
+            break;
+        }
+        lists.append(&it.value());
+    }
+    std::sort(lists.begin(), lists.end(), [](const QVector<int>* a, const QVector<int>* b) {
+        return a->size() < b->size();
+    });
+    if (!lists.isEmpty()) {
+        for (int row : *lists.first()) {
+            bool candidate = true;
+            for (int i = 1; candidate && i < lists.size(); ++i) {
+                candidate = std::binary_search(lists.at(i)->begin(), lists.at(i)->end(), row);
+            }
+            // Trigrams match out of order too, verify the substring
+            if (candidate && matchesText(row, text)) result.setBit(row);
+        }
+    }
+
+    // Rows not in the posting lists can still match by hash
+    if (IsHashQuery(text)) {
+        for (int row = 0; row < m_text.size(); ++row) {
+            if (!result.testBit(row) && matchesText(row, text)) result.setBit(row);
+        }
+    }
+    return result;
+}
+
+bool TransactionIndex::matchesText(int row, const QByteArray& text) const
+{
+    if (m_text.at(row).contains(text)) return true;
+    return IsHashQuery(text) && m_store->txhashContains(row, text);
+}
+
+QBitArray TransactionIndex::matchRange(QVector<Entry>& entries, int& sorted, qint64 min, qint64 max) const
+{
+    if (sorted < entries.size()) {
+        std::sort(entries.begin() + sorted, entries.end());
+        std::inplace_merge(entries.begin(), entries.begin() + sorted, entries.end());
+        sorted = entries.size();
+    }
+    QBitArray result(m_text.size());
+    auto first = std::lower_bound(entries.cbegin(), entries.cend(), Entry{ min, std::numeric_limits<int>::min() });
+    auto last = std::upper_bound(entries.cbegin(), entries.cend(), Entry{ max, std::numeric_limits<int>::max() });
+    for (auto it = first; it < last; ++it) {
+        result.setBit(it->second);
+    }
+    return result;
+}
+
+QVector<quint32> TransactionIndex::trigrams(const QByteArray& text)
+{
+    QVector<quint32> trigrams;
+    for (int i = 0; i + 2 < text.size(); ++i) {
+        trigrams.append(quint32(uchar(text.at(i))) << 16 | quint32(uchar(text.at(i + 1))) << 8 | uchar(text.at(i + 2)));
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
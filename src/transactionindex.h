@@ -0,0 +1,61 @@
+#ifndef GREEN_TRANSACTIONINDEX_H
+#define GREEN_TRANSACTIONINDEX_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class TransactionStore;
+
+// Search index over the rows of a TransactionStore, updated as rows are
+// added or changed. Memo and addresses are indexed by trigrams, candidates
+// are then verified against the indexed text. Amounts and timestamps are
+// kept in sorted arrays, new entries are merged in on the next query.
+class TransactionIndex
+{
+public:
+    struct Query {
+        // Case insensitive substring of memo, addresses or txhash
+        QString text;
+        // Creation time range in msecs since epoch, 0 for unbounded
+        qint64 from{0};
+        qint64 to{0};
+        // Range of any of the amounts, -1 for unbounded
+        qint64 min_amount{-1};
+        qint64 max_amount{-1};
+
+        bool isEmpty() const { return text.isEmpty() && from == 0 && to == 0 && min_amount < 0 && max_amount < 0; }
+    };
+
+    explicit TransactionIndex(const TransactionStore* store);
+
+    void update(int row);
+
+    // Returns a bit per indexed row set for the rows matching the query
+    QBitArray match(const Query& query) const;
+    bool matches(int row, const Query& query) const;
+
+private:
+    using Entry = QPair<qint64, int>;
+
+    QBitArray matchText(const QByteArray& text) const;
+    // Predicate shared by matches and the scans of matchText, the text is
+    // lower case
+    bool matchesText(int row, const QByteArray& text) const;
+    QBitArray matchRange(QVector<Entry>& entries, int& sorted, qint64 min, qint64 max) const;
+    static QVector<quint32> trigrams(const QByteArray& text);
+
+    const TransactionStore* const m_store;
+    // Lower case memo and addresses per row
+    QVector<QByteArray> m_text;
+    QHash<quint32, QVector<int>> m_postings;
+    // Entries past the sorted prefix are merged on the next query
+    mutable QVector<Entry> m_times;
+    mutable int m_sorted_times{0};
+    mutable QVector<Entry> m_amounts;
+    mutable int m_sorted_amounts{0};
+};
+
+#endif // GREEN_TRANSACTIONINDEX_H
@@ -1,20 +1,37 @@
 #include "account.h"
+#include "asset.h"
 #include "resolver.h"
 #include "transaction.h"
 #include "transactionlistmodel.h"
+#include "wallet.h"
+#include "session.h"
 #include "handlers/gettransactionshandler.h"
+#include <QCoreApplication>
 #include <QDebug>
+#include <QPointer>
+
+static const int PAGE_SIZE = 30;
 
 TransactionListModel::TransactionListModel(QObject* parent)
     : QAbstractListModel(parent)
     , m_reload_timer(new QTimer(this))
+    , m_save_timer(new QTimer(this))
 {
     m_reload_timer->setSingleShot(true);
     m_reload_timer->setInterval(200);
     connect(m_reload_timer, &QTimer::timeout, [this] {
-        m_has_unconfirmed = false;
-        fetch(true, 0, 30);
+        // Wait for the pending page, reconciling starts from the top
+        if (m_handler) {
+            m_reload_timer->start();
+            return;
+        }
+        m_reconciled.clear();
+        fetch(true, 0, PAGE_SIZE);
     });
+    // Paging and reconciling save the whole history, write it once they settle
+    m_save_timer->setSingleShot(true);
+    m_save_timer->setInterval(2000);
+    connect(m_save_timer, &QTimer::timeout, this, &TransactionListModel::save);
 }
 
 TransactionListModel::~TransactionListModel()
@@ -25,10 +42,23 @@ TransactionListModel::~TransactionListModel()
 void TransactionListModel::setAccount(Account *account)
 {
     if (m_account) {
+        if (m_save_timer->isActive()) {
+            m_save_timer->stop();
+            save();
+        }
         beginResetModel();
         m_handler = nullptr;
+        m_fetched = false;
+        ++m_load_request;
         m_transactions.clear();
+        m_reconciled.clear();
+        m_row_data.clear();
+        m_has_unconfirmed = false;
+        m_cache = {};
         disconnect(m_account, &Account::notificationHandled, this, &TransactionListModel::handleNotification);
+        disconnect(m_account, &Account::transactionUpdated, this, &TransactionListModel::handleTransactionUpdated);
+        disconnect(m_account->wallet(), &Wallet::settingsChanged, this, &TransactionListModel::invalidateAmounts);
+        disconnect(m_account->wallet(), &Wallet::assetsChanged, this, &TransactionListModel::invalidateAmounts);
         m_account = nullptr;
         emit accountChanged(nullptr);
         endResetModel();
@@ -38,10 +68,49 @@ void TransactionListModel::setAccount(Account *account)
     emit accountChanged(account);
     if (m_account) {
         connect(m_account, &Account::notificationHandled, this, &TransactionListModel::handleNotification);
-        fetchMore(QModelIndex());
+        connect(m_account, &Account::transactionUpdated, this, &TransactionListModel::handleTransactionUpdated);
+        connect(m_account->wallet(), &Wallet::settingsChanged, this, &TransactionListModel::invalidateAmounts);
+        // Asset precision and ticker only change when registry updates are applied
+        connect(m_account->wallet(), &Wallet::assetsChanged, this, &TransactionListModel::invalidateAmounts);
+        updateBlockHeight();
+        m_cache = TransactionCache(m_account->wallet()->m_id, m_account->pointer());
+        if (m_cache.isEnabled()) load();
+        fetch(true, 0, PAGE_SIZE);
     }
 }
 
+void TransactionListModel::load()
+{
+    // Render the cached history as soon as it's read, the first page
+    // fetched meanwhile is then reconciled against it
+    auto session = m_account->wallet()->session();
+    if (!session) return;
+    const int request = ++m_load_request;
+    const auto cache = m_cache;
+    // The model can go away while the cache is read, only the GUI thread
+    // checks the guard
+    QPointer<TransactionListModel> model(this);
+    QMetaObject::invokeMethod(session->context(Session::Lane::Background), [model, cache, request] {
+        const auto cached = cache.load();
+        if (cached.isEmpty()) return;
+        QMetaObject::invokeMethod(qApp, [model, cached, request] {
+            if (model) model->loaded(cached, request);
+        });
+    });
+}
+
+void TransactionListModel::loaded(const QJsonArray& cached, int request)
+{
+    // The account changed or the history was fetched first
+    if (request != m_load_request || m_fetched || !m_transactions.isEmpty()) return;
+    beginInsertRows(QModelIndex(), 0, cached.size() - 1);
+    for (QJsonValue data : cached) {
+        m_transactions.append(m_account->updateTransaction(data.toObject()));
+    }
+    endInsertRows();
+    updateHasUnconfirmed();
+}
+
 void TransactionListModel::handleNotification(const QJsonObject& notification)
 {
     QString event = notification.value("event").toString();
@@ -50,41 +119,75 @@ void TransactionListModel::handleNotification(const QJsonObject& notification)
         return;
     }
 
-    if (event == "block" && m_has_unconfirmed) {
-        reload();
+    if (event == "block") {
+        updateBlockHeight();
+        if (!m_transactions.isEmpty()) {
+            emit dataChanged(index(0), index(m_transactions.size() - 1), { ConfirmationsRole });
+        }
+        if (m_has_unconfirmed) reload();
         return;
     }
 }
 
-void TransactionListModel::fetch(bool reset, int offset, int count)
+void TransactionListModel::handleTransactionUpdated(int row)
+{
+    m_row_data.remove(row);
+    const int index = m_transactions.indexOf(row);
+    if (index >= 0) emit dataChanged(this->index(index), this->index(index));
+}
+
+void TransactionListModel::invalidateAmounts()
+{
+    for (auto& data : m_row_data) data.formatted_amounts.clear();
+    if (!m_transactions.isEmpty()) {
+        emit dataChanged(index(0), index(m_transactions.size() - 1), { FormattedAmountsRole });
+    }
+}
+
+void TransactionListModel::updateBlockHeight()
+{
+    m_block_height = m_account->wallet()->m_events.value("block").toObject().value("block_height").toInt();
+}
+
+void TransactionListModel::fetch(bool reconcile, int offset, int count)
 {
     auto handler = new GetTransactionsHandler(m_account->pointer(), offset, count, m_account->wallet());
 
-    QObject::connect(handler, &Handler::done, this, [this, reset, handler] {
+    QObject::connect(handler, &Handler::done, this, [this, reconcile, count, handler] {
         handler->deleteLater();
+        if (m_handler != handler) return;
         m_handler = nullptr;
+        m_fetched = true;
         emit fetchingChanged(false);
         // instantiate missing transactions
-        QVector<Transaction*> transactions;
+        QVector<int> transactions;
         for (QJsonValue data : handler->transactions()) {
-            auto transaction = m_account->getOrCreateTransaction(data.toObject());
-            transactions.append(transaction);
-            if (transaction->isUnconfirmed()) m_has_unconfirmed = true;
+            transactions.append(m_account->updateTransaction(data.toObject()));
         }
-        if (reset) {
-            // just swap rows instead of incremental update
-            // this happens after a bump fee for instance
-            beginResetModel();
-            m_transactions = transactions;
-            endResetModel();
+        if (reconcile) {
+            this->reconcile(transactions, count);
         } else {
-            // new page of transactions, just append to existing transaction
+            // new page of transactions, append the ones not shown yet since
+            // the history may have shifted down since the previous page
+            const QSet<int> present(m_transactions.begin(), m_transactions.end());
+            transactions.erase(std::remove_if(transactions.begin(), transactions.end(), [&](int transaction) {
+                return present.contains(transaction);
+            }), transactions.end());
+            if (transactions.isEmpty()) return;
             beginInsertRows(QModelIndex(), m_transactions.size(), m_transactions.size() + transactions.size() - 1);
             m_transactions.append(transactions);
             endInsertRows();
+            updateHasUnconfirmed();
+            scheduleSave();
         }
     });
 
+    connect(handler, &Handler::error, this, [this, handler] {
+        handler->deleteLater();
+        if (m_handler == handler) m_handler = nullptr;
+        emit fetchingChanged(false);
+    });
+
     connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
         resolver->resolve();
     });
@@ -94,10 +197,133 @@ void TransactionListModel::fetch(bool reset, int offset, int count)
     emit fetchingChanged(true);
 }
 
+void TransactionListModel::reconcile(const QVector<int>& page, int count)
+{
+    m_reconciled.append(page);
+
+    // Reached the end of the history
+    if (page.size() < count) return setTransactions(m_reconciled);
+
+    // Find a confirmed transaction from which the page lines up with the
+    // current rows, everything below it is assumed to be unchanged
+    for (int i = 0; i < page.size(); ++i) {
+        if (m_account->transactionStore().blockHeight(page.at(i)) == 0) continue;
+        const int index = m_transactions.indexOf(page.at(i));
+        if (index < 0) continue;
+        const int tail = page.size() - i;
+        if (m_transactions.mid(index, tail) != page.mid(i)) continue;
+        return setTransactions(m_reconciled + m_transactions.mid(index + tail));
+    }
+
+    // Fetched as many rows as were shown, the remaining are paged on demand
+    if (m_reconciled.size() >= m_transactions.size()) return setTransactions(m_reconciled);
+
+    fetch(true, m_reconciled.size(), count);
+}
+
+void TransactionListModel::setTransactions(const QVector<int>& list)
+{
+    m_reconciled.clear();
+
+    // Pages can overlap if the history shifts while reconciling
+    QVector<int> transactions;
+    QSet<int> keep;
+    for (auto transaction : list) {
+        if (keep.contains(transaction)) continue;
+        keep.insert(transaction);
+        transactions.append(transaction);
+    }
+
+    // Remove rows that are gone, like replaced unconfirmed transactions
+    for (int last = m_transactions.size() - 1; last >= 0;) {
+        if (keep.contains(m_transactions.at(last))) {
+            --last;
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !keep.contains(m_transactions.at(first - 1))) --first;
+        beginRemoveRows(QModelIndex(), first, last);
+        m_transactions.remove(first, last - first + 1);
+        endRemoveRows();
+        last = first - 1;
+    }
+
+    // Insert new rows and move existing rows into place, keyed by the store
+    // row since transactions are unique per hash in the account
+    const QSet<int> present(m_transactions.begin(), m_transactions.end());
+    for (int i = 0; i < transactions.size();) {
+        auto transaction = transactions.at(i);
+        if (i < m_transactions.size() && m_transactions.at(i) == transaction) {
+            ++i;
+            continue;
+        }
+        if (!present.contains(transaction)) {
+            int last = i;
+            while (last + 1 < transactions.size() && !present.contains(transactions.at(last + 1))) ++last;
+            beginInsertRows(QModelIndex(), i, last);
+            m_transactions.insert(i, last - i + 1, -1);
+            std::copy(transactions.begin() + i, transactions.begin() + last + 1, m_transactions.begin() + i);
+            endInsertRows();
+            i = last + 1;
+            continue;
+        }
+        const int from = m_transactions.indexOf(transaction, i + 1);
+        Q_ASSERT(from > i);
+        beginMoveRows(QModelIndex(), from, from, QModelIndex(), i);
+        m_transactions.move(from, i);
+        endMoveRows();
+        ++i;
+    }
+    Q_ASSERT(m_transactions == transactions);
+
+    updateHasUnconfirmed();
+    scheduleSave();
+}
+
+void TransactionListModel::updateHasUnconfirmed()
+{
+    m_has_unconfirmed = false;
+    for (auto transaction : m_transactions) {
+        if (m_account->transactionStore().blockHeight(transaction) == 0) m_has_unconfirmed = true;
+    }
+}
+
+void TransactionListModel::scheduleSave()
+{
+    if (m_cache.isEnabled()) m_save_timer->start();
+}
+
+void TransactionListModel::save()
+{
+    auto session = m_account->wallet()->session();
+    if (!m_cache.isEnabled() || !session) return;
+    // Only copy the raw store rows here, decoding and writing the history
+    // is left to the background lane
+    const auto& store = m_account->transactionStore();
+    QVector<TransactionCache::Record> records;
+    records.reserve(m_transactions.size());
+    for (auto row : m_transactions) {
+        records.append({ store.details(row), store.txhash(row), store.blockHeight(row) });
+    }
+    const auto cache = m_cache;
+    QMetaObject::invokeMethod(session->context(Session::Lane::Background), [cache, records] {
+        cache.save(records);
+    });
+}
+
 QHash<int, QByteArray> TransactionListModel::roleNames() const
 {
     return {
-        { Qt::UserRole, "transaction" }
+        { TransactionRole, "transaction" },
+        { TxHashRole, "txhash" },
+        { TypeRole, "type" },
+        { MemoRole, "memo" },
+        { CreatedAtRole, "createdAt" },
+        { ConfirmationsRole, "confirmations" },
+        { FormattedAmountsRole, "formattedAmounts" },
+        { AssetIdsRole, "assetIds" },
+        { IsRelevantRole, "isRelevant" },
+        { CanRbfRole, "canRbf" }
     };
 }
 
@@ -114,7 +340,7 @@ void TransactionListModel::fetchMore(const QModelIndex &parent)
     Q_ASSERT(!parent.parent().isValid());
     if (!m_account) return;
     if (m_handler) return;
-    fetch(false, m_transactions.size(), 30);
+    fetch(false, m_transactions.size(), PAGE_SIZE);
 }
 
 int TransactionListModel::rowCount(const QModelIndex &parent) const
@@ -131,10 +357,66 @@ int TransactionListModel::columnCount(const QModelIndex &parent) const
 
 QVariant TransactionListModel::data(const QModelIndex &index, int role) const
 {
-    if (role == Qt::UserRole) return QVariant::fromValue(m_transactions.at(index.row()));
+    const int row = m_transactions.at(index.row());
+    const auto& store = m_account->transactionStore();
+    switch (role) {
+    // Transaction objects are only created when accessed
+    case TransactionRole: return QVariant::fromValue(m_account->transaction(row));
+    case TxHashRole: return store.txhash(row);
+    case TypeRole: return rowData(row).type;
+    case MemoRole: return rowData(row).memo;
+    case CreatedAtRole: return rowData(row).created_at;
+    case ConfirmationsRole: {
+        const int block_height = store.blockHeight(row);
+        if (block_height == 0) return 0;
+        return qMax(1, 1 + m_block_height - block_height);
+    }
+    case FormattedAmountsRole: return rowData(row).formatted_amounts;
+    case AssetIdsRole: return rowData(row).asset_ids;
+    case IsRelevantRole: return rowData(row).is_relevant;
+    case CanRbfRole: return rowData(row).can_rbf;
+    }
     return QVariant();
 }
 
+const TransactionListModel::RowData& TransactionListModel::rowData(int row) const
+{
+    auto it = m_row_data.find(row);
+    if (it == m_row_data.end()) {
+        const auto& store = m_account->transactionStore();
+        const auto data = store.data(row);
+        RowData row_data;
+        row_data.type = data.value("type").toString();
+        row_data.memo = data.value("memo").toString().trimmed().replace('\n', ' ');
+        row_data.created_at = QDateTime::fromMSecsSinceEpoch(store.createdAt(row));
+        // Relevant when any output belongs to the wallet
+        row_data.is_relevant = false;
+        for (const auto value : data.value("outputs").toArray()) {
+            if (value.toObject().value("is_relevant").toBool()) row_data.is_relevant = true;
+        }
+        row_data.can_rbf = data.value("can_rbf").toBool();
+        for (const auto& amount : store.amounts(row)) {
+            row_data.asset_ids.append(amount.asset < 0 ? QString() : store.assetId(amount.asset));
+        }
+        it = m_row_data.insert(row, row_data);
+    }
+    if (it->formatted_amounts.isEmpty()) {
+        const auto& store = m_account->transactionStore();
+        const auto wallet = m_account->wallet();
+        const QString prefix = store.type(row) != TransactionStore::Incoming ? "-" : "";
+        for (const auto& amount : store.amounts(row)) {
+            if (amount.asset < 0) {
+                it->formatted_amounts.append(prefix + wallet->formatAmount(amount.value, true));
+            } else {
+                auto asset = wallet->getOrCreateAsset(store.assetId(amount.asset));
+                if (!asset) continue;
+                it->formatted_amounts.append(prefix + asset->formatAmount(amount.value, true));
+            }
+        }
+    }
+    return *it;
+}
+
 void TransactionListModel::reload()
 {
     if (!m_account) return;
@@ -1,6 +1,8 @@
 #ifndef TRANSACTIONLISTMODEL_H
 #define TRANSACTIONLISTMODEL_H
 
+#include "transactioncache.h"
+
 #include <QtQml>
 #include <QAbstractListModel>
 #include <QVector>
@@ -17,12 +19,28 @@ class TransactionListModel : public QAbstractListModel
     Q_PROPERTY(bool fetching READ fetching NOTIFY fetchingChanged)
     QML_ELEMENT
 public:
+    enum Role {
+        TransactionRole = Qt::UserRole,
+        TxHashRole,
+        TypeRole,
+        MemoRole,
+        CreatedAtRole,
+        ConfirmationsRole,
+        FormattedAmountsRole,
+        AssetIdsRole,
+        IsRelevantRole,
+        CanRbfRole,
+    };
+    Q_ENUM(Role)
+
     TransactionListModel(QObject* parent = nullptr);
     ~TransactionListModel();
 
     Account* account() const { return m_account; }
     void setAccount(Account* account);
     bool fetching() const { return m_handler != nullptr; }
+    // Row in the account transaction store of the given model row
+    int storeRow(int index) const { return m_transactions.at(index); }
 
     QHash<int,QByteArray> roleNames() const override;
     void fetchMore(const QModelIndex &parent) override;
@@ -37,14 +55,46 @@ signals:
     void fetchingChanged(bool fetching);
 private slots:
     void handleNotification(const QJsonObject& notification);
+    void handleTransactionUpdated(int row);
+    void invalidateAmounts();
 private:
-    void fetch(bool reset, int offset, int count);
+    // Role values computed once per row from the transaction store
+    struct RowData {
+        QString type;
+        QString memo;
+        QDateTime created_at;
+        QStringList formatted_amounts;
+        QStringList asset_ids;
+        bool is_relevant;
+        bool can_rbf;
+    };
+    const RowData& rowData(int row) const;
+    void updateBlockHeight();
+    void fetch(bool reconcile, int offset, int count);
+    void reconcile(const QVector<int>& page, int count);
+    void setTransactions(const QVector<int>& transactions);
+    void updateHasUnconfirmed();
+    void load();
+    void loaded(const QJsonArray& cached, int request);
+    void scheduleSave();
+    void save();
 private:
     Account* m_account{nullptr};
-    QVector<Transaction*> m_transactions;
+    // Rows in the account transaction store, newest first
+    QVector<int> m_transactions;
+    // Rows fetched from the top while reconciling with the cached rows
+    QVector<int> m_reconciled;
+    TransactionCache m_cache;
+    // Drops cache loads finished after the account changed
+    int m_load_request{0};
+    // Set once a page was fetched, cache loads finished later are ignored
+    bool m_fetched{false};
+    mutable QHash<int, RowData> m_row_data;
+    int m_block_height{0};
     bool m_has_unconfirmed{false};
     Handler* m_handler{nullptr};
     QTimer* const m_reload_timer;
+    QTimer* const m_save_timer;
 };
 
 #endif // TRANSACTIONLISTMODEL_H
@@ -0,0 +1,203 @@
+#include "transactionstore.h"
+
+#include <QCborMap>
+#include <QCborValue>
+#include <QDateTime>
+#include <QVarLengthArray>
+#include <QtEndian>
+
+namespace {
+
+const int HASH_SIZE = 32;
+
+quint64 HashKey(const char* hash)
+{
+    return qFromUnaligned<quint64>(hash);
+}
+
+TransactionStore::Type ParseType(const QString& type)
+{
+    if (type == "outgoing") return TransactionStore::Outgoing;
+    if (type == "redeposit") return TransactionStore::Redeposit;
+    Q_ASSERT(type == "incoming");
+    return TransactionStore::Incoming;
+}
+
+// Fields kept in their own column are not repeated in the details
+QByteArray PackDetails(QJsonObject data)
+{
+    data.remove("txhash");
+    data.remove("block_height");
+    return QCborValue::fromJsonValue(data).toCbor();
+}
+
+} // namespace
+
+QVector<QPair<QString, qint64>> TransactionStore::parseAmounts(const QJsonObject& data, bool liquid)
+{
+    QVector<QPair<QString, qint64>> amounts;
+    const auto satoshi = data.value("satoshi").toObject();
+    const Type type = ParseType(data.value("type").toString());
+    if (!liquid) {
+        amounts.append({ QString(), qint64(satoshi.value("btc").toDouble()) });
+    } else if (type == Redeposit) {
+        Q_ASSERT(satoshi.contains("btc"));
+        amounts.append({ QString(), qint64(satoshi.value("btc").toDouble()) });
+    } else if (type == Incoming) {
+        for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
+            amounts.append({ i.key(), qint64(i.value().toDouble()) });
+        }
+    } else if (satoshi.size() == 1) {
+        Q_ASSERT(satoshi.contains("btc"));
+        amounts.append({ "btc", qint64(satoshi.value("btc").toDouble()) });
+    } else {
+        const qint64 fee = data.value("fee").toDouble();
+        for (auto i = satoshi.constBegin(); i != satoshi.constEnd(); ++i) {
+            qint64 amount = i.value().toDouble();
+            if (i.key() == "btc") {
+                Q_ASSERT(fee <= amount);
+                amount -= fee;
+                if (amount == 0) continue; // just fee
+            }
+            amounts.append({ i.key(), amount });
+        }
+    }
+    return amounts;
+}
+
+qint64 TransactionStore::parseCreatedAt(const QJsonObject& data)
+{
+    // Microseconds since epoch, not available in older gdk versions
+    if (data.contains("created_at_ts")) return data.value("created_at_ts").toDouble() / 1000;
+    auto created_at = QDateTime::fromString(data.value("created_at").toString(), "yyyy-MM-dd HH:mm:ss");
+    created_at.setTimeSpec(Qt::UTC);
+    return created_at.toMSecsSinceEpoch();
+}
+
+int TransactionStore::indexOf(const QString& txhash) const
+{
+    const QByteArray hash = QByteArray::fromHex(txhash.toLatin1());
+    if (hash.size() != HASH_SIZE) return -1;
+    for (auto it = m_index.find(HashKey(hash.constData())); it != m_index.end() && it.key() == HashKey(hash.constData()); ++it) {
+        if (memcmp(m_hashes.constData() + it.value() * HASH_SIZE, hash.constData(), HASH_SIZE) == 0) return it.value();
+    }
+    return -1;
+}
+
+int TransactionStore::insert(const QJsonObject& data, bool liquid, bool* changed)
+{
+    const auto txhash = data.value("txhash").toString();
+    const int block_height = data.value("block_height").toInt();
+    int row = indexOf(txhash);
+    if (row >= 0) {
+        // Amounts, type and fee don't change, only confirmation and details
+        const QByteArray details = PackDetails(data);
+        const bool updated = m_block_heights.at(row) != block_height || m_details.at(row) != details;
+        if (updated) {
+            m_block_heights[row] = block_height;
+            m_details[row] = details;
+        }
+        if (changed) *changed = updated;
+        return row;
+    }
+
+    const QByteArray hash = QByteArray::fromHex(txhash.toLatin1());
+    Q_ASSERT(hash.size() == HASH_SIZE);
+    row = size();
+    m_hashes.append(hash);
+    m_index.insert(HashKey(hash.constData()), row);
+    const Type type = ParseType(data.value("type").toString());
+    m_types.append(type);
+    m_block_heights.append(block_height);
+    m_created_at.append(parseCreatedAt(data));
+    const qint64 fee = data.value("fee").toDouble();
+    m_fees.append(fee);
+    m_details.append(PackDetails(data));
+
+    for (const auto& amount : parseAmounts(data, liquid)) {
+        m_amount_assets.append(amount.first.isEmpty() ? -1 : internAsset(amount.first));
+        m_amount_values.append(amount.second);
+    }
+    m_amount_offsets.append(m_amount_values.size());
+
+    if (changed) *changed = true;
+    return row;
+}
+
+void TransactionStore::setMemo(int row, const QString& memo)
+{
+    auto details = QCborValue::fromCbor(m_details.at(row)).toMap();
+    details.insert(QLatin1String("memo"), memo);
+    m_details[row] = details.toCborValue().toCbor();
+}
+
+QString TransactionStore::txhash(int row) const
+{
+    return QString::fromLatin1(m_hashes.mid(row * HASH_SIZE, HASH_SIZE).toHex());
+}
+
+bool TransactionStore::txhashContains(int row, const QByteArray& hex) const
+{
+    const int count = 2 * HASH_SIZE;
+    if (hex.isEmpty() || hex.size() > count) return false;
+    QVarLengthArray<uchar, 2 * HASH_SIZE> digits(hex.size());
+    for (int i = 0; i < hex.size(); ++i) {
+        const char c = hex.at(i);
+        if (c >= '0' && c <= '9') digits[i] = c - '0';
+        else if (c >= 'a' && c <= 'f') digits[i] = c - 'a' + 10;
+        else return false;
+    }
+    const auto hash = reinterpret_cast<const uchar*>(m_hashes.constData()) + row * HASH_SIZE;
+    const auto digit = [hash](int i) { return i % 2 ? hash[i / 2] & 0xf : hash[i / 2] >> 4; };
+    for (int start = 0; start + digits.size() <= count; ++start) {
+        int i = 0;
+        while (i < digits.size() && digit(start + i) == digits.at(i)) ++i;
+        if (i == digits.size()) return true;
+    }
+    return false;
+}
+
+QVector<TransactionStore::Amount> TransactionStore::amounts(int row) const
+{
+    QVector<Amount> amounts;
+    for (int i = m_amount_offsets.at(row); i < m_amount_offsets.at(row + 1); ++i) {
+        amounts.append({ m_amount_assets.at(i), m_amount_values.at(i) });
+    }
+    return amounts;
+}
+
+QJsonObject TransactionStore::data(int row) const
+{
+    auto data = QCborValue::fromCbor(m_details.at(row)).toMap().toJsonObject();
+    data.insert("txhash", txhash(row));
+    data.insert("block_height", m_block_heights.at(row));
+    return data;
+}
+
+qint64 TransactionStore::memoryUsage() const
+{
+    qint64 usage = m_hashes.capacity();
+    usage += m_index.size() * (sizeof(quint64) + sizeof(int) + 2 * sizeof(void*));
+    usage += m_types.capacity() * sizeof(quint8);
+    usage += m_block_heights.capacity() * sizeof(qint32);
+    usage += m_created_at.capacity() * sizeof(qint64);
+    usage += m_fees.capacity() * sizeof(qint64);
+    usage += m_amount_offsets.capacity() * sizeof(int);
+    usage += m_amount_assets.capacity() * sizeof(int);
+    usage += m_amount_values.capacity() * sizeof(qint64);
+    for (const auto& id : m_asset_ids) usage += id.capacity() * sizeof(QChar);
+    usage += m_asset_index.size() * (sizeof(QString) + sizeof(int) + 2 * sizeof(void*));
+    usage += m_details.capacity() * sizeof(QByteArray);
+    for (const auto& details : m_details) usage += details.capacity();
+    return usage;
+}
+
+int TransactionStore::internAsset(const QString& id)
+{
+    auto it = m_asset_index.constFind(id);
+    if (it != m_asset_index.constEnd()) return it.value();
+    const int index = m_asset_ids.size();
+    m_asset_ids.append(id);
+    m_asset_index.insert(id, index);
+    return index;
+}
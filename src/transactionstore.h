@@ -0,0 +1,82 @@
+#ifndef GREEN_TRANSACTIONSTORE_H
+#define GREEN_TRANSACTIONSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QJsonObject>
+#include <QStringList>
+#include <QVector>
+
+// Columnar storage of the transactions of an account. Rows are appended in
+// arrival order and never removed, the row index is stable and identifies a
+// transaction, the history order is kept by the models.
+//
+// Fixed size fields are kept in one vector per field, hashes are packed in
+// a single byte array, amounts are stored contiguously with per row offsets
+// and reference interned asset ids. The remaining details, like inputs and
+// outputs, are kept as CBOR and decoded on demand.
+class TransactionStore
+{
+public:
+    enum Type : quint8 { Incoming, Outgoing, Redeposit };
+
+    struct Amount {
+        // Index of the interned asset id, -1 for the policy asset amounts
+        // that are formatted with the wallet unit
+        int asset;
+        qint64 value;
+    };
+
+    // Amounts of a transaction as returned by GA_get_transactions, keyed by
+    // asset id, empty for the policy asset amounts formatted with the
+    // wallet unit
+    static QVector<QPair<QString, qint64>> parseAmounts(const QJsonObject& data, bool liquid);
+    // Creation time in msecs since epoch
+    static qint64 parseCreatedAt(const QJsonObject& data);
+
+    int size() const { return m_types.size(); }
+
+    // Returns the row of the given txhash or -1
+    int indexOf(const QString& txhash) const;
+
+    // Adds a transaction as returned by GA_get_transactions or updates the
+    // existing row, returns the row
+    int insert(const QJsonObject& data, bool liquid, bool* changed = nullptr);
+    void setMemo(int row, const QString& memo);
+
+    QString txhash(int row) const;
+    // Whether the hex txhash contains the given lower case hex digits,
+    // compared against the packed hash without formatting it
+    bool txhashContains(int row, const QByteArray& hex) const;
+    Type type(int row) const { return static_cast<Type>(m_types.at(row)); }
+    qint64 createdAt(int row) const { return m_created_at.at(row); }
+    int blockHeight(int row) const { return m_block_heights.at(row); }
+    qint64 fee(int row) const { return m_fees.at(row); }
+    QVector<Amount> amounts(int row) const;
+    QString assetId(int index) const { return m_asset_ids.at(index); }
+
+    QJsonObject data(int row) const;
+    QByteArray details(int row) const { return m_details.at(row); }
+
+    // Approximate heap usage in bytes
+    qint64 memoryUsage() const;
+
+private:
+    int internAsset(const QString& id);
+
+    QByteArray m_hashes;
+    // Rows by the first 8 bytes of the hash
+    QMultiHash<quint64, int> m_index;
+    QVector<quint8> m_types;
+    QVector<qint32> m_block_heights;
+    QVector<qint64> m_created_at;
+    QVector<qint64> m_fees;
+    QVector<int> m_amount_offsets{0};
+    QVector<int> m_amount_assets;
+    QVector<qint64> m_amount_values;
+    QStringList m_asset_ids;
+    QHash<QString, int> m_asset_index;
+    QVector<QByteArray> m_details;
+};
+
+#endif // GREEN_TRANSACTIONSTORE_H
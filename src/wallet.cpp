@@ -1,5 +1,6 @@
 #include "account.h"
 #include "asset.h"
+#include "asseticonprovider.h"
 #include "ga.h"
 #include "json.h"
 #include "network.h"
@@ -15,9 +16,11 @@
 #include <type_traits>
 
 #include <QDateTime>
+#include <QCryptographicHash>
 #include <QDebug>
+#include <QJsonDocument>
 #include <QJsonObject>
-#include <QLocale>
+#include <QSet>
 #include <QSettings>
 #include <QTimer>
 #include <QUuid>
@@ -31,10 +34,15 @@ class GetSubAccountsHandler : public Handler
         int res = GA_get_subaccounts(session, auth_handler);
         Q_ASSERT(res == GA_OK);
     }
+    QByteArray key() const override
+    {
+        return "get_subaccounts";
+    }
 public:
     GetSubAccountsHandler(Wallet* wallet)
         : Handler(wallet)
     {
+        setLane(Session::Lane::Background);
     }
 };
 
@@ -171,9 +179,12 @@ void Wallet::disconnect()
     emit accountsChanged();
 
     m_settings = {};
+    m_converter = {};
     m_config = {};
     m_currencies = {};
     m_events = {};
+    cancelPendingAssets();
+    m_asset_digests.clear();
 
     setConnection(Disconnected);
     setAuthentication(Unauthenticated);
@@ -182,7 +193,7 @@ void Wallet::disconnect()
     m_session = nullptr;
 
     qDeleteAll(accounts);
-    qDeleteAll(m_assets.values());
+    qDeleteAll(m_assets.assets());
     m_assets.clear();
 }
 
@@ -256,15 +267,24 @@ void Wallet::handleNotification(const QJsonObject &notification)
         timer->start(100);
         QObject::connect(timer, &QTimer::timeout, [this] {
             qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
-            setBusy(timestamp - m_last_timestamp > 300);
+            bool busy = false;
+            for (const auto& last_timestamp : m_last_timestamps) {
+                busy = busy || timestamp - last_timestamp > 300;
+            }
+            setBusy(busy);
         });
-        QMetaObject::invokeMethod(m_session->m_context, [this] {
-            auto timer = new QTimer(m_session->m_context);
-            timer->start(100);
-            QObject::connect(timer, &QTimer::timeout, [this] {
-                m_last_timestamp = QDateTime::currentMSecsSinceEpoch();
+        for (int lane = 0; lane < Session::LANE_COUNT; ++lane) {
+            auto& last_timestamp = m_last_timestamps[lane];
+            last_timestamp = QDateTime::currentMSecsSinceEpoch();
+            auto context = m_session->context(Session::Lane(lane));
+            QMetaObject::invokeMethod(context, [context, &last_timestamp] {
+                auto timer = new QTimer(context);
+                timer->start(100);
+                QObject::connect(timer, &QTimer::timeout, [&last_timestamp] {
+                    last_timestamp = QDateTime::currentMSecsSinceEpoch();
+                });
             });
-        });
+        }
         return;
     }
 
@@ -278,6 +298,17 @@ void Wallet::handleNotification(const QJsonObject &notification)
         return;
     }
 
+    if (event == "ticker") {
+        const auto ticker = data.toObject();
+        const auto currency = ticker.value("currencies").toObject().value("fiat").toString();
+        // Rates for other currencies than the pricing one are ignored
+        const auto pricing = m_settings.value("pricing").toObject().value("currency").toString();
+        if (currency.isEmpty() || (!pricing.isEmpty() && currency != pricing)) return;
+        const auto rate = ticker.value("rate");
+        m_converter.setFiatRate(currency, rate.isString() ? rate.toString() : QString::number(rate.toDouble(), 'f', 8));
+        return;
+    }
+
     if (event == "block") {
         for (auto account : m_accounts) {
             account->handleNotification(notification);
@@ -438,6 +469,7 @@ void Wallet::reload()
 
     auto handler = new GetSubAccountsHandler(this);
     QObject::connect(handler, &Handler::done, this, [this, handler] {
+        handler->deleteLater();
         QJsonArray accounts = handler->result().value("result").toObject().value("subaccounts").toArray();
 
         for (QJsonValue data : accounts) {
@@ -457,6 +489,9 @@ void Wallet::reload()
             refreshAssets(true);
         }
     });
+    QObject::connect(handler, &Handler::error, this, [handler] {
+        handler->deleteLater();
+    });
     QObject::connect(handler, &Handler::resolver, this, [](Resolver* resolver) {
         resolver->resolve();
     });
@@ -467,14 +502,28 @@ void Wallet::refreshAssets(bool refresh)
 {
     Q_ASSERT(m_network->isLiquid());
 
-    QMetaObject::invokeMethod(m_session->m_context, [this, refresh] {
+    // Only the latest refresh is applied, it includes the updates of the
+    // superseded one since their digests are forgotten
+    cancelPendingAssets();
+    const int request = m_asset_refresh;
+    auto session = m_session;
+
+    // Assets without metadata are always part of the delta, these were
+    // created by balances or transactions after the registry was applied
+    QSet<QString> referenced;
+    for (auto asset : m_assets.assets()) {
+        if (!asset->hasData()) referenced.insert(asset->id());
+    }
+
+    // Registry refresh can take a while, keep it away from interactive calls
+    QMetaObject::invokeMethod(m_session->context(Session::Lane::Background), [this, session, request, refresh, digests = m_asset_digests, referenced] {
         auto params = Json::fromObject({
             { "assets", true },
             { "icons", true },
             { "refresh", refresh }
         });
         GA_json* output;
-        int err = GA_refresh_assets(m_session->m_session, params.get(), &output);
+        int err = GA_refresh_assets(session->m_session, params.get(), &output);
         if (err != GA_OK) {
             return;
         }
@@ -483,25 +532,94 @@ void Wallet::refreshAssets(bool refresh)
         err = GA_destroy_json(output);
         Q_ASSERT(err == GA_OK);
 
-        QMetaObject::invokeMethod(this, [this, assets] {
-            auto icons = assets.value("icons").toObject();
-
-            for (auto&& ref : assets.value("assets").toObject()) {
-                QString id = ref.toObject().value("asset_id").toString();
-                if (id.isEmpty()) continue;
-                Asset* asset = getOrCreateAsset(id);
-                asset->setData(ref.toObject());
-                if (icons.contains(id)) {
-                    asset->setIcon("data:image/png;base64," + icons.value(id).toString());
-                }
+        // Compare each registry entry against the digest of what was last
+        // applied, icons are persisted as raw PNG files and only their URLs
+        // reach the GUI thread
+        const auto icons = assets.value("icons").toObject();
+        const auto registry = assets.value("assets").toObject();
+        QHash<QString, QByteArray> next_digests;
+        next_digests.reserve(registry.size());
+        QVector<AssetUpdate> updates;
+        int referenced_count = 0;
+        for (auto i = registry.begin(); i != registry.end(); ++i) {
+            const auto data = i.value().toObject();
+            const QString id = data.value("asset_id").toString();
+            if (id.isEmpty()) continue;
+            const QString icon = icons.value(id).toString();
+            const QByteArray json = QJsonDocument(data).toJson(QJsonDocument::Compact);
+            QCryptographicHash hash(QCryptographicHash::Md5);
+            hash.addData(json);
+            QByteArray digest = hash.result();
+            hash.reset();
+            hash.addData(icon.toLatin1());
+            digest.append(hash.result());
+            next_digests.insert(id, digest);
+
+            const QByteArray previous = digests.value(id);
+            const bool icon_changed = previous.mid(16) != digest.mid(16);
+            if (previous == digest && !referenced.contains(id)) continue;
+            if (!icon.isEmpty() && icon_changed) {
+                AssetIconProvider::store(id, QByteArray::fromBase64(icon.toLatin1()));
             }
-            for (auto account : m_accounts) {
-                account->updateBalance();
+            AssetUpdate update{ id, json, !icon.isEmpty() };
+            if (referenced.contains(id)) {
+                // Assets shown in balances are applied first
+                updates.insert(referenced_count++, update);
+            } else {
+                updates.append(update);
             }
+        }
+
+        QMetaObject::invokeMethod(this, [this, request, updates, next_digests] {
+            // A later refresh or a disconnect superseded this one
+            if (request != m_asset_refresh) return;
+            Q_ASSERT(m_pending_assets.isEmpty());
+            m_asset_digests = next_digests;
+            m_pending_assets = updates;
+            if (!m_pending_assets.isEmpty()) applyPendingAssets();
         });
     });
 }
 
+void Wallet::applyPendingAssets()
+{
+    // Apply a bounded batch per event loop iteration so that the first
+    // registry load doesn't stall the interface
+    const int batch_size = 200;
+    const int count = qMin(batch_size, m_pending_assets.size());
+    for (int i = 0; i < count; ++i) {
+        const auto& update = m_pending_assets.at(i);
+        AssetTable::Id id;
+        if (!AssetTable::parseId(update.id, id)) continue;
+        auto entry = m_assets.insert(id);
+        entry->data = update.data;
+        // Assets not yet materialized pick the metadata up when created
+        Asset* asset = entry->asset;
+        if (!asset) continue;
+        asset->setData(QJsonDocument::fromJson(update.data).object());
+        if (update.icon) asset->setIcon(AssetIconProvider::url(update.id));
+    }
+    m_pending_assets.remove(0, count);
+    if (!m_pending_assets.isEmpty()) {
+        QTimer::singleShot(0, this, [this, request = m_asset_refresh] {
+            if (request == m_asset_refresh) applyPendingAssets();
+        });
+        return;
+    }
+
+    emit assetsChanged();
+}
+
+void Wallet::cancelPendingAssets()
+{
+    // Updates not applied yet must be part of the next delta
+    for (const auto& update : m_pending_assets) {
+        m_asset_digests.remove(update.id);
+    }
+    m_pending_assets.clear();
+    ++m_asset_refresh;
+}
+
 void Wallet::updateConfig()
 {
     GA_json* config;
@@ -571,35 +689,23 @@ void Wallet::setAuthentication(AuthenticationStatus authentication)
 
 QJsonObject Wallet::convert(const QJsonObject& value) const
 {
-    auto details = Json::fromObject(value);
-    GA_json* balance;
-    int err = GA_convert_amount(m_session->m_session, details.get(), &balance);
-    if (err != GA_OK) return {};
-    QJsonObject result = Json::toObject(balance);
-    GA_destroy_json(balance);
-    return result;
+    return m_converter.convert(value);
 }
 
 QString Wallet::formatAmount(qint64 amount, bool include_ticker) const
 {
-    return formatAmount(amount, include_ticker, m_settings.value("unit").toString());
+    return formatAmount(amount, include_ticker, {});
 }
 
 QString Wallet::formatAmount(qint64 amount, bool include_ticker, const QString& unit) const
 {
     Q_ASSERT(m_network);
-    const auto effective_unit = unit.isEmpty() ? m_settings.value("unit").toString() : unit;
+    const auto effective_unit = unit.isEmpty() ? m_converter.unit() : unit;
     if (effective_unit.isEmpty()) {
         return {};
     }
-    auto str = convert({{ "satoshi", amount }}).value(effective_unit == "\u00B5BTC" ? "ubtc" : effective_unit.toLower()).toString();
-    auto val = str.toDouble();
-    if (val == ((int64_t) val)) {
-        str = QLocale::system().toString(val, 'f', 0);
-    } else {
-        str = QLocale::system().toString(val, 'f', 8);
-        str.remove(QRegExp("\\.?0+$"));
-    }
+    const auto number = unit.isEmpty() ? m_converter.format(amount) : AmountConverter::format(amount, AmountConverter::unitKey(unit));
+    auto str = AmountConverter::toLocaleString(number);
     if (include_ticker) {
         str += (m_network->isLiquid() ? " L-" : " ") + effective_unit;
     }
@@ -608,21 +714,51 @@ QString Wallet::formatAmount(qint64 amount, bool include_ticker, const QString&
 
 qint64 Wallet::amountToSats(const QString& amount) const
 {
-    return parseAmount(amount, m_settings.value("unit").toString());
+    return parseAmount(amount, {});
 }
 
 qint64 Wallet::parseAmount(const QString& amount, const QString& unit) const
 {
-    if (amount.isEmpty()) return 0;
+    qint64 satoshi;
+    if (!parseAmount(amount, unit, satoshi)) {
+        qWarning() << "invalid amount" << amount << "in" << (unit.isEmpty() ? m_converter.unit() : unit);
+        return 0;
+    }
+    return satoshi;
+}
+
+bool Wallet::parseAmount(const QString& amount, const QString& unit, qint64& satoshi) const
+{
+    satoshi = 0;
+    if (amount.isEmpty()) return true;
     QString sanitized_amount = amount;
     sanitized_amount.replace(',', '.');
-    auto details = Json::fromObject({{ unit == "\u00B5BTC" ? "ubtc" : unit.toLower(), sanitized_amount }});
-    GA_json* balance;
-    int err = GA_convert_amount(m_session->m_session, details.get(), &balance);
-    if (err != GA_OK) return 0;
-    QJsonObject result = Json::toObject(balance);
-    GA_destroy_json(balance);
-    return result.value("sats").toString().toLongLong();
+    // Fails on malformed input, overflow and digits beyond the unit precision
+    if (unit.isEmpty()) return m_converter.parse(sanitized_amount, satoshi);
+    return AmountConverter::parse(sanitized_amount, AmountConverter::unitKey(unit), satoshi);
+}
+
+void Wallet::updateFiatRate()
+{
+    // Pricing source changes are only visible through GDK, ask once for the
+    // current rate and keep it until the next settings change or ticker event
+    if (!m_session) return;
+    const int request = ++m_fiat_rate_request;
+    auto session = m_session;
+    QMetaObject::invokeMethod(m_session->context(Session::Lane::Background), [this, session, request] {
+        auto details = Json::fromObject({{ "satoshi", 0 }});
+        GA_json* balance;
+        int err = GA_convert_amount(session->m_session, details.get(), &balance);
+        if (err != GA_OK) return;
+        QJsonObject result = Json::toObject(balance);
+        GA_destroy_json(balance);
+        QMetaObject::invokeMethod(this, [this, request, result] {
+            // A later settings change superseded this request
+            if (request != m_fiat_rate_request) return;
+            const auto rate = result.value("fiat_rate");
+            m_converter.setFiatRate(result.value("fiat_currency").toString(), rate.isString() ? rate.toString() : QString());
+        });
+    });
 }
 
 Asset* Wallet::getOrCreateAsset(const QString& id)
@@ -630,12 +766,19 @@ Asset* Wallet::getOrCreateAsset(const QString& id)
     Q_ASSERT(m_network && m_network->isLiquid());
     QString key = id == "btc" ? "6f0279e9ed041c3d710a9f57d0c02928416460c4b722ae3457a11eec381c526d" : id;
 
-    Asset* asset = m_assets.value(key);
-    if (!asset) {
-        asset = new Asset(key, this);
-        m_assets.insert(key, asset);
+    AssetTable::Id asset_id{};
+    if (!AssetTable::parseId(key, asset_id)) {
+        qWarning() << "invalid asset id" << id;
+        return nullptr;
+    }
+    auto entry = m_assets.insert(asset_id);
+    if (!entry->asset) {
+        entry->asset = new Asset(key, this);
+        if (!entry->data.isEmpty()) {
+            entry->asset->setData(QJsonDocument::fromJson(entry->data).object());
+        }
     }
-    return asset;
+    return entry->asset;
 }
 
 void Wallet::setBusy(bool busy)
@@ -693,6 +836,8 @@ void Wallet::setSettings(const QJsonObject& settings)
 {
     if (m_settings == settings) return;
     m_settings = settings;
+    m_converter.setUnit(m_settings.value("unit").toString());
+    updateFiatRate();
     emit settingsChanged();
 
     if (m_logout_timer != -1 ) {
@@ -1,19 +1,24 @@
 #ifndef GREEN_WALLET_H
 #define GREEN_WALLET_H
 
+#include "amountconverter.h"
+#include "assettable.h"
+#include "session.h"
+
 #include <QtQml>
 #include <QAtomicInteger>
+#include <QHash>
 #include <QList>
 #include <QObject>
 #include <QQmlListProperty>
 #include <QThread>
 #include <QJsonObject>
+#include <QVector>
 
 class Account;
 class Asset;
 class Device;
 class Network;
-class Session;
 
 struct GA_session;
 struct GA_auth_handler;
@@ -105,10 +110,13 @@ public:
 
     qint64 amountToSats(const QString& amount) const;
     Q_INVOKABLE qint64 parseAmount(const QString& amount, const QString& unit) const;
+    // Returns false for invalid amounts, an empty unit uses the settings unit
+    bool parseAmount(const QString& amount, const QString& unit, qint64& satoshi) const;
 
     QString formatAmount(qint64 amount, bool include_ticker) const;
     Q_INVOKABLE QString formatAmount(qint64 amount, bool include_ticker, const QString& unit) const;
 
+    // Returns nullptr for ids that are not 64 hex characters
     Q_INVOKABLE Asset* getOrCreateAsset(const QString& id);
 
     bool isBusy() const { return m_busy; }
@@ -149,6 +157,8 @@ signals:
     void busyChanged(bool busy);
     void loginError(const QString& error);
     void pinSet();
+    // Registry metadata of assets was updated
+    void assetsChanged();
 
 protected:
     bool eventFilter(QObject* object, QEvent* event) override;
@@ -160,19 +170,38 @@ private:
     void setSettings(const QJsonObject& settings);
     void connectNow();
     void updateCurrencies();
+    void updateFiatRate();
+    void applyPendingAssets();
+    void cancelPendingAssets();
+
+    struct AssetUpdate {
+        QString id;
+        // Registry metadata as compact JSON
+        QByteArray data;
+        bool icon;
+    };
 
 public:
     QString m_id;
-    QAtomicInteger<qint64> m_last_timestamp;
+    // Heartbeat of each session lane, the wallet is busy while any lane is
+    // stuck in a GDK call
+    QAtomicInteger<qint64> m_last_timestamps[Session::LANE_COUNT];
     Session* m_session{nullptr};
     ConnectionStatus m_connection{Disconnected};
     AuthenticationStatus m_authentication{Unauthenticated};
     bool m_locked{true};
     QJsonObject m_settings;
+    AmountConverter m_converter;
+    int m_fiat_rate_request{0};
     QJsonObject m_config;
     QJsonObject m_currencies;
     QJsonObject m_events;
-    QMap<QString, Asset*> m_assets;
+    AssetTable m_assets;
+    // Digest of the registry data and icon last applied to each asset
+    QHash<QString, QByteArray> m_asset_digests;
+    QVector<AssetUpdate> m_pending_assets;
+    // Drops the results and batches of superseded asset refreshes
+    int m_asset_refresh{0};
     QList<Account*> m_accounts;
     QMap<int, Account*> m_accounts_by_pointer;
 
@@ -3,6 +3,7 @@
 #include "network.h"
 #include "networkmanager.h"
 #include "session.h"
+#include "transactioncache.h"
 #include "util.h"
 #include "wallet.h"
 #include "walletmanager.h"
@@ -89,6 +90,7 @@ void WalletManager::removeWallet(Wallet* wallet)
             QMetaObject::invokeMethod(wallet, [wallet] {
                 bool result = QFile::remove(GetDataFile("wallets", wallet->m_id));
                 Q_ASSERT(result);
+                TransactionCache::remove(wallet->m_id);
             });
         });
     }
@@ -0,0 +1,16 @@
+QT += testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_assettable
+
+INCLUDEPATH += $$PWD/../../src
+
+SOURCES += \
+    tst_assettable.cpp \
+    $$PWD/../../src/assettable.cpp
+
+HEADERS += \
+    $$PWD/../../src/assettable.h
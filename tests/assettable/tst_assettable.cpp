@@ -0,0 +1,59 @@
+#include "assettable.h"
+
+#include <QtTest>
+
+namespace {
+
+// Ids sharing the leading bytes used to pick a slot
+AssetTable::Id CollidingId(uchar last)
+{
+    AssetTable::Id id{};
+    id.fill(0xab);
+    id.back() = last;
+    return id;
+}
+
+} // namespace
+
+class TestAssetTable : public QObject
+{
+    Q_OBJECT
+private slots:
+    void collisionAndRemoval();
+};
+
+void TestAssetTable::collisionAndRemoval()
+{
+    AssetTable table;
+    QVector<AssetTable::Id> ids;
+    for (uchar i = 0; i < 100; ++i) {
+        ids.append(CollidingId(i));
+        table.insert(ids.last())->data = QByteArray(1, char(i));
+    }
+    QCOMPARE(table.size(), ids.size());
+
+    // Every colliding id keeps its own entry, also after the table grew
+    for (const auto& id : ids) {
+        auto entry = table.find(id);
+        QVERIFY(entry);
+        QVERIFY(entry->id == id);
+        QCOMPARE(entry->data, QByteArray(1, char(id.back())));
+    }
+    QVERIFY(!table.find(CollidingId(200)));
+    QCOMPARE(table.insert(ids.first()), table.find(ids.first()));
+    QCOMPARE(table.size(), ids.size());
+
+    table.clear();
+    QCOMPARE(table.size(), 0);
+    for (const auto& id : ids) QVERIFY(!table.find(id));
+
+    // Entries inserted after a clear start empty
+    auto entry = table.insert(ids.last());
+    QVERIFY(entry->data.isEmpty());
+    QCOMPARE(table.size(), 1);
+    QVERIFY(!table.find(ids.first()));
+}
+
+QTEST_APPLESS_MAIN(TestAssetTable)
+
+#include "tst_assettable.moc"
@@ -0,0 +1,16 @@
+QT += testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_hidframing
+
+INCLUDEPATH += $$PWD/../../src
+
+SOURCES += \
+    tst_hidframing.cpp \
+    $$PWD/../../src/hidframing.cpp
+
+HEADERS += \
+    $$PWD/../../src/hidframing.h
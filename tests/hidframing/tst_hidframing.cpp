@@ -0,0 +1,64 @@
+#include "hidframing.h"
+
+#include <QtEndian>
+#include <QtTest>
+
+namespace {
+
+// Report of a 260 byte APDU, without the report id, with its sequence
+// index replaced
+QByteArray Report(const HIDFrameWriter& writer, quint16 index)
+{
+    QByteArray report(writer.report(qMin<int>(index, writer.count() - 1)) + 1, HIDFrameWriter::REPORT_SIZE);
+    qToBigEndian<quint16>(index, report.data() + 3);
+    return report;
+}
+
+} // namespace
+
+class TestHIDFraming : public QObject
+{
+    Q_OBJECT
+private slots:
+    void invalidSequence_data();
+    void invalidSequence();
+};
+
+void TestHIDFraming::invalidSequence_data()
+{
+    // Sequence indexes read in order, only the last one is invalid
+    QTest::addColumn<QVector<int>>("indexes");
+    QTest::newRow("no first report") << QVector<int>{ 1 };
+    QTest::newRow("skipped") << QVector<int>{ 0, 2 };
+    QTest::newRow("repeated") << QVector<int>{ 0, 1, 1 };
+    QTest::newRow("backwards") << QVector<int>{ 0, 1, 2, 1 };
+    QTest::newRow("past the end") << QVector<int>{ 0, 1, 2, 3, 4, 5 };
+}
+
+void TestHIDFraming::invalidSequence()
+{
+    QFETCH(QVector<int>, indexes);
+    HIDFrameWriter writer;
+    QCOMPARE(writer.frame(QByteArray(260, 'x')), 5);
+    HIDFrameReader reader;
+    for (int i = 0; i < indexes.size(); ++i) {
+        const auto report = Report(writer, indexes.at(i));
+        const auto result = reader.read(report.constData(), report.size());
+        if (i + 1 < indexes.size()) {
+            QVERIFY(result != HIDFrameReader::Invalid);
+        } else {
+            QCOMPARE(result, HIDFrameReader::Invalid);
+        }
+    }
+
+    // A new response starts over at index 0
+    for (int i = 0; i < writer.count(); ++i) {
+        const auto report = Report(writer, i);
+        QCOMPARE(reader.read(report.constData(), report.size()), i + 1 < writer.count() ? HIDFrameReader::Incomplete : HIDFrameReader::Complete);
+    }
+    QCOMPARE(reader.response(), QByteArray(260, 'x'));
+}
+
+QTEST_APPLESS_MAIN(TestHIDFraming)
+
+#include "tst_hidframing.moc"
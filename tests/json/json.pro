@@ -0,0 +1,17 @@
+QT += testlib
+QT -= gui
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_json
+
+INCLUDEPATH += $$PWD/../../src $${GDK_PATH}
+LIBS += -L$${GDK_PATH} -lgreenaddress
+
+SOURCES += \
+    tst_json.cpp \
+    $$PWD/../../src/json.cpp
+
+HEADERS += \
+    $$PWD/../../src/json.h
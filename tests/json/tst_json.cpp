@@ -0,0 +1,34 @@
+#include "json.h"
+
+#include <gdk.h>
+
+#include <QtTest>
+
+class TestJson : public QObject
+{
+    Q_OBJECT
+private slots:
+    void roundTrip();
+};
+
+void TestJson::roundTrip()
+{
+    const QJsonObject object{
+        { "null", QJsonValue::Null },
+        { "nested", QJsonArray{
+            QJsonArray{ 1, QJsonArray{ 2, QJsonValue::Null } },
+            QJsonArray{},
+            QJsonArray{ QJsonObject{{ "empty", QJsonArray{} }} }
+        } },
+        { "object", QJsonObject{
+            { "values", QJsonArray{ true, false, "text", 1.5 } },
+            { "null", QJsonValue::Null }
+        } }
+    };
+    auto json = Json::fromObject(object);
+    QCOMPARE(Json::toObject(json.get()), object);
+}
+
+QTEST_APPLESS_MAIN(TestJson)
+
+#include "tst_json.moc"
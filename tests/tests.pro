@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    assettable \
+    hidframing
+
+# Needs GDK, run qmake with GDK_PATH set as for the application
+defined(GDK_PATH, var): SUBDIRS += json